@@ -0,0 +1,357 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "events_correlate.h"
+
+#define EVENTSCORRELATE_BUCKETS_INITIAL_SIZE 1024
+#define EVENTSCORRELATE_ARRAY_INITIAL_SIZE 16
+#define EVENTSCORRELATE_KEY_MAXIMUM_SIZE 256
+
+void EventsCorrelate_Init(struct EventsCorrelate *correlate)
+{
+	memset(correlate, 0, sizeof(*correlate));
+}
+
+static void EventsCorrelate_ClearPending(struct EventsCorrelate *correlate)
+{
+	struct EventsCorrelate_Pending *pending, *next;
+	size_t i;
+
+	for (i = 0; i < correlate->buckets_size; i++)
+		for (pending = correlate->buckets[i]; pending != NULL; 
+		     pending = next) {
+			next = pending->next;
+			free(pending->times);
+			free(pending);
+		}
+	free(correlate->buckets);
+}
+
+void EventsCorrelate_Done(struct EventsCorrelate *correlate)
+{
+	if (correlate->active) {
+		regfree(&correlate->from.key);
+		regfree(&correlate->to.key);
+		free(correlate->from.marker_name);
+		free(correlate->to.marker_name);
+	}
+	EventsCorrelate_ClearPending(correlate);
+	free(correlate->latencies);
+	EventsCorrelate_Init(correlate);
+}
+
+/* Markers are stored with the brackets blanked, " SB_TLP " matches SB_TLP */
+static bool EventsCorrelate_MarkerMatches(const char *marker, const char *name)
+{
+	size_t length;
+
+	while (' ' == *marker)
+		marker++;
+	length = strlen(name);
+	if (0 != strncmp(marker, name, length))
+		return false;
+	for (marker += length; *marker; marker++)
+		if (' ' != *marker)
+			return false;
+	return true;
+}
+
+void EventsCorrelate_MarkerAdded(struct EventsCorrelate *correlate, 
+	const char *marker)
+{
+	if (!correlate->active)
+		return;
+	if (NULL == correlate->from.marker &&
+	    EventsCorrelate_MarkerMatches(marker, correlate->from.marker_name))
+		correlate->from.marker = marker;
+	if (NULL == correlate->to.marker &&
+	    EventsCorrelate_MarkerMatches(marker, correlate->to.marker_name))
+		correlate->to.marker = marker;
+}
+
+static int EventsCorrelate_SetupSide(struct EventsCorrelate_Side *side,
+	const char *marker, const char *pattern)
+{
+	if (regcomp(&side->key, pattern, REG_EXTENDED))
+		return -1;
+	side->marker_name = strdup(marker);
+	assert(NULL != side->marker_name);
+	side->marker = NULL;
+	return 0;
+}
+
+int EventsCorrelate_Setup(struct EventsCorrelate *correlate,
+	const char *from_marker, const char *from_pattern,
+	const char *to_marker, const char *to_pattern)
+{
+	EventsCorrelate_Done(correlate);
+
+	if (EventsCorrelate_SetupSide(&correlate->from, from_marker, from_pattern))
+		return -1;
+	if (EventsCorrelate_SetupSide(&correlate->to, to_marker, to_pattern)) {
+		regfree(&correlate->from.key);
+		free(correlate->from.marker_name);
+		return -1;
+	}
+
+	correlate->buckets_size = EVENTSCORRELATE_BUCKETS_INITIAL_SIZE;
+	correlate->buckets = calloc(correlate->buckets_size, 
+		sizeof(*correlate->buckets));
+	assert(NULL != correlate->buckets);
+	correlate->active = true;
+	return 0;
+}
+
+static bool EventsCorrelate_Key(struct EventsCorrelate_Side *side, 
+	const char *message, char *key)
+{
+	size_t n_match = 2, length;
+	regmatch_t matches[n_match];
+	regmatch_t *match;
+
+	if (regexec(&side->key, message, n_match, matches, 0))
+		return false;
+
+	match = (-1 != matches[1].rm_so) ? &matches[1] : &matches[0];
+	length = match->rm_eo - match->rm_so;
+	if (length >= EVENTSCORRELATE_KEY_MAXIMUM_SIZE)
+		length = EVENTSCORRELATE_KEY_MAXIMUM_SIZE - 1;
+	memcpy(key, &message[match->rm_so], length);
+	key[length] = 0;
+	return true;
+}
+
+static uint32_t EventsCorrelate_Hash(const char *key)
+{
+	uint32_t hash = 2166136261u;
+
+	while (*key) {
+		hash ^= (unsigned char)*key++;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+static void EventsCorrelate_Rehash(struct EventsCorrelate *correlate)
+{
+	struct EventsCorrelate_Pending **buckets, *pending, *next;
+	size_t buckets_size, i, j;
+
+	buckets_size = correlate->buckets_size * 2;
+	buckets = calloc(buckets_size, sizeof(*buckets));
+	assert(NULL != buckets);
+
+	for (i = 0; i < correlate->buckets_size; i++)
+		for (pending = correlate->buckets[i]; pending != NULL; 
+		     pending = next) {
+			next = pending->next;
+			j = EventsCorrelate_Hash(pending->key) & (buckets_size - 1);
+			pending->next = buckets[j];
+			buckets[j] = pending;
+		}
+	free(correlate->buckets);
+	correlate->buckets = buckets;
+	correlate->buckets_size = buckets_size;
+}
+
+static struct EventsCorrelate_Pending **EventsCorrelate_Find(
+	struct EventsCorrelate *correlate, const char *key)
+{
+	struct EventsCorrelate_Pending **link;
+	size_t i;
+
+	i = EventsCorrelate_Hash(key) & (correlate->buckets_size - 1);
+	for (link = &correlate->buckets[i]; *link != NULL; link = &(*link)->next)
+		if (0 == strcmp((*link)->key, key))
+			break;
+	return link;
+}
+
+static void EventsCorrelate_Insert(struct EventsCorrelate *correlate, 
+	const char *key, unsigned long long time)
+{
+	struct EventsCorrelate_Pending **link, *pending;
+	size_t size;
+
+	if (correlate->pending_keys >= correlate->buckets_size)
+		EventsCorrelate_Rehash(correlate);
+
+	link = EventsCorrelate_Find(correlate, key);
+	pending = *link;
+	if (NULL == pending) {
+		pending = calloc(1, sizeof(*pending) + strlen(key) + 1);
+		assert(NULL != pending);
+		strcpy(pending->key, key);
+		*link = pending;
+		correlate->pending_keys++;
+	}
+
+	if (pending->first + pending->length == pending->capacity) {
+		if (pending->first > 0) {
+			memmove(pending->times, &pending->times[pending->first],
+				pending->length * sizeof(*pending->times));
+			pending->first = 0;
+		} else {
+			pending->capacity = pending->capacity ? 
+				pending->capacity * 2 : 
+				EVENTSCORRELATE_ARRAY_INITIAL_SIZE;
+			size = pending->capacity * sizeof(*pending->times);
+			pending->times = realloc(pending->times, size);
+			assert(NULL != pending->times);
+		}
+	}
+	pending->times[pending->first + pending->length++] = time;
+	correlate->pending_events++;
+}
+
+static void EventsCorrelate_AddLatency(struct EventsCorrelate *correlate,
+	unsigned long long latency)
+{
+	size_t size;
+
+	if (correlate->latencies_length == correlate->latencies_capacity) {
+		correlate->latencies_capacity = correlate->latencies_capacity ?
+			correlate->latencies_capacity * 2 : 
+			EVENTSCORRELATE_ARRAY_INITIAL_SIZE;
+		size = correlate->latencies_capacity * 
+			sizeof(*correlate->latencies);
+		correlate->latencies = realloc(correlate->latencies, size);
+		assert(NULL != correlate->latencies);
+	}
+	correlate->latencies[correlate->latencies_length++] = latency;
+}
+
+static void EventsCorrelate_Probe(struct EventsCorrelate *correlate, 
+	const char *key, unsigned long long time)
+{
+	struct EventsCorrelate_Pending **link, *pending;
+	unsigned long long from_time;
+
+	link = EventsCorrelate_Find(correlate, key);
+	pending = *link;
+	if (NULL == pending) {
+		correlate->unmatched_to++;
+		return;
+	}
+
+	from_time = pending->times[pending->first];
+	pending->first++;
+	pending->length--;
+	correlate->pending_events--;
+	EventsCorrelate_AddLatency(correlate, 
+		time > from_time ? time - from_time : 0);
+
+	if (0 == pending->length) {
+		*link = pending->next;
+		free(pending->times);
+		free(pending);
+		correlate->pending_keys--;
+	}
+}
+
+/* Start events of a run are never paired with end events of the next one */
+static void EventsCorrelate_NewRun(struct EventsCorrelate *correlate, 
+	size_t run)
+{
+	correlate->unmatched_from += correlate->pending_events;
+	EventsCorrelate_ClearPending(correlate);
+	correlate->buckets = calloc(correlate->buckets_size, 
+		sizeof(*correlate->buckets));
+	assert(NULL != correlate->buckets);
+	correlate->pending_keys = 0;
+	correlate->pending_events = 0;
+	correlate->run = run;
+}
+
+/* Events come in the log order, the runs one after another */
+void EventsCorrelate_Feed(struct EventsCorrelate *correlate, 
+	const char *marker, size_t run, unsigned long long time, 
+	const char *message)
+{
+	char key[EVENTSCORRELATE_KEY_MAXIMUM_SIZE];
+
+	if (!correlate->active)
+		return;
+	if (run != correlate->run)
+		EventsCorrelate_NewRun(correlate, run);
+
+	if (marker == correlate->to.marker && 
+	    EventsCorrelate_Key(&correlate->to, message, key))
+		EventsCorrelate_Probe(correlate, key, time);
+
+	if (marker == correlate->from.marker && 
+	    EventsCorrelate_Key(&correlate->from, message, key))
+		EventsCorrelate_Insert(correlate, key, time);
+}
+
+static int EventsCorrelate_Compare(const void *a, const void *b)
+{
+	unsigned long long x = *(const unsigned long long *)a;
+	unsigned long long y = *(const unsigned long long *)b;
+
+	return (x > y) - (x < y);
+}
+
+static unsigned long long EventsCorrelate_Percentile(
+	unsigned long long *sorted, size_t length, unsigned int percent)
+{
+	size_t rank;
+
+	rank = (length * percent + 99) / 100;
+	return sorted[rank ? rank - 1 : 0];
+}
+
+void EventsCorrelate_GetReport(struct EventsCorrelate *correlate,
+	struct EventsCorrelate_Report *report)
+{
+	unsigned long long *sorted;
+	unsigned long long sum = 0;
+	size_t i, length;
+
+	memset(report, 0, sizeof(*report));
+	length = correlate->latencies_length;
+	report->count = length;
+	report->unmatched_from = correlate->unmatched_from + 
+		correlate->pending_events;
+	report->unmatched_to = correlate->unmatched_to;
+	if (0 == length)
+		return;
+
+	sorted = malloc(length * sizeof(*sorted));
+	assert(NULL != sorted);
+	memcpy(sorted, correlate->latencies, length * sizeof(*sorted));
+	qsort(sorted, length, sizeof(*sorted), EventsCorrelate_Compare);
+
+	for (i = 0; i < length; i++)
+		sum += sorted[i];
+	report->min = sorted[0];
+	report->max = sorted[length - 1];
+	report->mean = (double)sum / length;
+	report->p50 = EventsCorrelate_Percentile(sorted, length, 50);
+	report->p90 = EventsCorrelate_Percentile(sorted, length, 90);
+	report->p99 = EventsCorrelate_Percentile(sorted, length, 99);
+	free(sorted);
+}
+
+void EventsCorrelate_Print(struct EventsCorrelate *correlate, FILE *output)
+{
+	struct EventsCorrelate_Report report;
+
+	if (!correlate->active)
+		return;
+
+	EventsCorrelate_GetReport(correlate, &report);
+	fprintf(output, "%s -> %s: %zu pairs, %zu unmatched %s, "
+		"%zu unmatched %s\n",
+		correlate->from.marker_name, correlate->to.marker_name,
+		report.count, 
+		report.unmatched_from, correlate->from.marker_name,
+		report.unmatched_to, correlate->to.marker_name);
+	if (0 == report.count)
+		return;
+	fprintf(output, "latency min %llu, max %llu, mean %.1f, "
+		"p50 %llu, p90 %llu, p99 %llu\n",
+		report.min, report.max, report.mean, 
+		report.p50, report.p90, report.p99);
+}
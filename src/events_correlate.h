@@ -0,0 +1,79 @@
+#ifndef __EVENTS_CORRELATE__
+#define __EVENTS_CORRELATE__
+
+#include <regex.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+/* Start events waiting for their end event, FIFO per key */
+struct EventsCorrelate_Pending {
+	struct EventsCorrelate_Pending *next;
+	unsigned long long *times;
+	size_t first;
+	size_t length;
+	size_t capacity;
+	char key[];
+};
+
+struct EventsCorrelate_Side {
+	char *marker_name;
+	const char *marker;	/* interned marker once seen */
+	regex_t key;
+};
+
+/* Pairs a start event with the first later end event of the same key, the
+ * key is the first capture group of the side pattern (whole match without
+ * groups) applied to the message */
+struct EventsCorrelate {
+	bool active;
+	struct EventsCorrelate_Side from;
+	struct EventsCorrelate_Side to;
+
+	struct EventsCorrelate_Pending **buckets;
+	size_t buckets_size;
+	size_t pending_keys;
+	size_t pending_events;
+
+	unsigned long long *latencies;
+	size_t latencies_length;
+	size_t latencies_capacity;
+	size_t unmatched_to;
+
+	/* Start events left pending by the runs before the current one */
+	size_t run;
+	size_t unmatched_from;
+};
+
+struct EventsCorrelate_Report {
+	size_t count;
+	size_t unmatched_from;
+	size_t unmatched_to;
+	unsigned long long min;
+	unsigned long long max;
+	double mean;
+	unsigned long long p50;
+	unsigned long long p90;
+	unsigned long long p99;
+};
+
+void EventsCorrelate_Init(struct EventsCorrelate *correlate);
+
+void EventsCorrelate_Done(struct EventsCorrelate *correlate);
+
+int EventsCorrelate_Setup(struct EventsCorrelate *correlate,
+	const char *from_marker, const char *from_pattern,
+	const char *to_marker, const char *to_pattern);
+
+void EventsCorrelate_MarkerAdded(struct EventsCorrelate *correlate, 
+	const char *marker);
+
+void EventsCorrelate_Feed(struct EventsCorrelate *correlate, 
+	const char *marker, size_t run, unsigned long long time, 
+	const char *message);
+
+void EventsCorrelate_GetReport(struct EventsCorrelate *correlate,
+	struct EventsCorrelate_Report *report);
+
+void EventsCorrelate_Print(struct EventsCorrelate *correlate, FILE *output);
+
+#endif
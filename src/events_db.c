@@ -6,6 +6,31 @@
 #include "events_db.h"
 
 #define EVENTSDB_LINE_BUFFER_SIZE 1024
+#define EVENTSDB_INDEX_INITIAL_SIZE 64
+
+/* Walks the events of one run: the whole events queue when every severity
+ * is shown, a merge of the enabled severity indexes otherwise. Events of
+ * equal times next to each other are taken as one group of rows */
+struct EventsDb_RowCursor {
+	struct events_queue_entry *np;
+	size_t position[EVENTSDB_SEVERITY_TOTAL];
+	size_t run;
+	struct markers_queue_entry **markers;
+
+	struct events_queue_entry *next;
+	const char *time;	/* NULL once the run is over */
+	unsigned long long time_value;
+	struct events_queue_entry **group;	/* events of time */
+	size_t count;
+	size_t capacity;
+};
+
+static const char *EventsDb_SeverityNames[EVENTSDB_SEVERITY_TOTAL] = {
+	[EVENTSDB_SEVERITY_INFO]    = "INFO",
+	[EVENTSDB_SEVERITY_WARNING] = "WARNING",
+	[EVENTSDB_SEVERITY_ERROR]   = "ERROR",
+	[EVENTSDB_SEVERITY_FATAL]   = "FATAL",
+};
 
 enum EventsDb_Error EventsDb_Init(struct EventsDb *eventsdb){
 	enum EventsDb_Error err;
@@ -16,11 +41,20 @@ enum EventsDb_Error EventsDb_Init(struct EventsDb *eventsdb){
 		EVENTSDB_PATTERN_EXTRACT_TIME,
 		EVENTSDB_PATTERN_EXTRACT_MESSAGE);
 	if(err) return err;
+	err = EventsDb_NewPathPattern(eventsdb, EVENTSDB_PATTERN_EXTRACT_PATH);
+	if(err) return err;
 
 	TAILQ_INIT(&eventsdb->m_queue);
 	TAILQ_INIT(&eventsdb->e_queue);
 	TAILQ_INIT(&eventsdb->t_queue);
 	eventsdb->t_queue_length = 0;
+	eventsdb->e_queue_length = 0;
+	eventsdb->severity_mask = EVENTSDB_SEVERITY_MASK_ALL;
+	EventsPaths_Init(&eventsdb->paths);
+	EventsDensity_Init(&eventsdb->density);
+	EventsStats_Init(&eventsdb->stats);
+	EventsDict_Init(&eventsdb->dict);
+	EventsCorrelate_Init(&eventsdb->correlate);
 
 	eventsdb->response = NULL;
 	eventsdb->response_rows = 0;
@@ -29,55 +63,198 @@ enum EventsDb_Error EventsDb_Init(struct EventsDb *eventsdb){
 	return EVENTSDB_OK;
 }
 
+static bool EventsDb_PatternIs(struct EventsMatcher_Pattern *pattern, 
+	const char *source)
+{
+	return pattern->compiled && 0 == strcmp(pattern->source, source);
+}
+
+static void EventsDb_UpdateFastPath(struct EventsDb *eventsdb)
+{
+	eventsdb->uvm_fast_path = 
+		EventsDb_PatternIs(&eventsdb->regex_line_valid, 
+			EVENTSDB_PATTERN_LINE_VALID) &&
+		EventsDb_PatternIs(&eventsdb->regex_extract_marker, 
+			EVENTSDB_PATTERN_EXTRACT_MARKER) &&
+		EventsDb_PatternIs(&eventsdb->regex_extract_time, 
+			EVENTSDB_PATTERN_EXTRACT_TIME) &&
+		EventsDb_PatternIs(&eventsdb->regex_extract_message, 
+			EVENTSDB_PATTERN_EXTRACT_MESSAGE) &&
+		(!eventsdb->regex_extract_path.compiled ||
+		 EventsDb_PatternIs(&eventsdb->regex_extract_path, 
+			EVENTSDB_PATTERN_EXTRACT_PATH));
+	eventsdb->compiled_path = 
+		NULL != eventsdb->regex_line_valid.automaton &&
+		NULL != eventsdb->regex_extract_marker.automaton &&
+		NULL != eventsdb->regex_extract_time.automaton &&
+		NULL != eventsdb->regex_extract_message.automaton &&
+		(!eventsdb->regex_extract_path.compiled ||
+		 NULL != eventsdb->regex_extract_path.automaton);
+	eventsdb->multibyte = 
+		eventsdb->regex_line_valid.multibyte ||
+		eventsdb->regex_extract_marker.multibyte ||
+		eventsdb->regex_extract_time.multibyte ||
+		eventsdb->regex_extract_message.multibyte ||
+		eventsdb->regex_extract_path.multibyte;
+}
+
 enum EventsDb_Error EventsDb_NewPatterns(struct EventsDb *eventsdb,
 	const char *pattern_line_valid, 
 	const char *pattern_extract_marker,
 	const char *pattern_extract_time,
 	const char *pattern_extract_message)
 {
-	int err;
+	struct EventsMatcher_Pattern line_valid, marker, time, message;
+	enum EventsDb_Error err = EVENTSDB_PATTERN_EXTRACT_WRONG;
+
+	memset(&marker, 0, sizeof(marker));
+	memset(&time, 0, sizeof(time));
+	memset(&message, 0, sizeof(message));
+
+	if (EventsMatcher_Compile(&line_valid, pattern_line_valid, 0))
+		return EVENTSDB_PATTERN_LINE_VALID_WRONG;
+	if (EventsMatcher_Compile(&marker, pattern_extract_marker, REG_EXTENDED))
+		goto fail;
+	if (EventsMatcher_Compile(&time, pattern_extract_time, REG_EXTENDED))
+		goto fail;
+	if (EventsMatcher_Compile(&message, pattern_extract_message, REG_EXTENDED))
+		goto fail;
+
+	/* Old patterns are kept until all the new ones compiled */
+	EventsMatcher_Free(&eventsdb->regex_line_valid);
+	EventsMatcher_Free(&eventsdb->regex_extract_marker);
+	EventsMatcher_Free(&eventsdb->regex_extract_time);
+	EventsMatcher_Free(&eventsdb->regex_extract_message);
+	eventsdb->regex_line_valid = line_valid;
+	eventsdb->regex_extract_marker = marker;
+	eventsdb->regex_extract_time = time;
+	eventsdb->regex_extract_message = message;
+	EventsDb_UpdateFastPath(eventsdb);
 
-	err = regcomp(&eventsdb->regex_line_valid, pattern_line_valid, 0);
-	if(err) return EVENTSDB_PATTERN_LINE_VALID_WRONG;
+	return EVENTSDB_OK;
+fail:
+	EventsMatcher_Free(&line_valid);
+	EventsMatcher_Free(&marker);
+	EventsMatcher_Free(&time);
+	EventsMatcher_Free(&message);
+	return err;
+}
 
-	err = regcomp(&eventsdb->regex_extract_marker, pattern_extract_marker, 
-		REG_EXTENDED);
-	if(err) return EVENTSDB_PATTERN_EXTRACT_WRONG;
+/* NULL pattern disables the hierarchy, all events go to the root */
+enum EventsDb_Error EventsDb_NewPathPattern(struct EventsDb *eventsdb,
+	const char *pattern_extract_path)
+{
+	struct EventsMatcher_Pattern path;
 
-	err = regcomp(&eventsdb->regex_extract_time, pattern_extract_time, 
-		REG_EXTENDED);
-	if(err) return EVENTSDB_PATTERN_EXTRACT_WRONG;
+	memset(&path, 0, sizeof(path));
+	if (NULL != pattern_extract_path &&
+	    EventsMatcher_Compile(&path, pattern_extract_path, REG_EXTENDED))
+		return EVENTSDB_PATTERN_EXTRACT_WRONG;
 
-	err = regcomp(&eventsdb->regex_extract_message, pattern_extract_message, 
-		REG_EXTENDED);
-	if(err) return EVENTSDB_PATTERN_EXTRACT_WRONG;
+	EventsMatcher_Free(&eventsdb->regex_extract_path);
+	eventsdb->regex_extract_path = path;
+	EventsDb_UpdateFastPath(eventsdb);
 
 	return EVENTSDB_OK;
 }
 
-static void EventsDb_AddEventBody(struct EventsDb *eventsdb, const char *marker,
-	const char *time, const char *message)
+static void EventsDb_IndexAppend(struct events_index *index, 
+	struct events_queue_entry *entry)
+{
+	size_t size;
+
+	if (index->length == index->capacity) {
+		index->capacity = index->capacity ? 
+			index->capacity * 2 : EVENTSDB_INDEX_INITIAL_SIZE;
+		size = index->capacity * sizeof(*index->entries);
+		index->entries = realloc(index->entries, size);
+		assert(NULL != index->entries);
+	}
+	index->entries[index->length++] = entry;
+}
+
+static void EventsDb_IndexFree(struct events_index *index)
+{
+	free(index->entries);
+	memset(index, 0, sizeof(*index));
+}
+
+static void EventsDb_AddEventBody(struct EventsDb *eventsdb, 
+	struct markers_queue_entry *marker_entry, const char *time, 
+	const char *message, enum EventsDb_Severity severity,
+	struct EventsPaths_Node *path, unsigned long long time_value)
 {
 	struct events_queue_entry *entry;
 
 	entry = malloc(sizeof(*entry));
 	assert(NULL != entry);
 
-	entry->marker = marker;
+	entry->marker = marker_entry->marker;
+	entry->marker_id = marker_entry->id;
 	entry->time = time;
 	entry->message = message;
+	entry->time_value = time_value;
+	entry->index = eventsdb->e_queue_length++;
+	entry->severity = severity;
+	entry->path = path;
 
 	TAILQ_INSERT_TAIL(&eventsdb->e_queue, entry, entries);
+	EventsDb_IndexAppend(&eventsdb->severity_index[severity], entry);
+}
+
+static enum EventsDb_Error EventsDb_StoreEvent(struct EventsDb *eventsdb,
+	struct markers_queue_entry *marker_entry, const char *time, 
+	const char *message, enum EventsDb_Severity severity,
+	struct EventsPaths_Node *path, unsigned long long time_value)
+{
+	int err;
+
+	err = EventsStore_Append(&eventsdb->store, time_value, time, message, 
+		marker_entry->id, path->id, severity);
+	eventsdb->e_queue_length++;
+	return err ? EVENTSDB_STORE_FAILED : EVENTSDB_OK;
 }
 
-static void EventsDb_AddMarker(struct EventsDb *eventsdb, const char *marker)
+static char *EventsDb_Scratch(struct EventsDb *eventsdb, 
+	enum EventsDb_Field field, size_t size)
+{
+	if (size > eventsdb->scratch_size[field]) {
+		eventsdb->scratch[field] = realloc(eventsdb->scratch[field], size);
+		assert(NULL != eventsdb->scratch[field]);
+		eventsdb->scratch_size[field] = size;
+	}
+	return eventsdb->scratch[field];
+}
+
+static const char *EventsDb_RunMarker(struct EventsDb *eventsdb, 
+	const char *base, size_t run)
+{
+	char *name;
+	size_t length;
+
+	if (0 == run)
+		return base;
+
+	length = snprintf(NULL, 0, EVENTSDB_RUN_MARKER_FORMAT, base, run + 1);
+	name = EventsDb_Scratch(eventsdb, EVENTSDB_FIELD_MARKER, length + 1);
+	snprintf(name, length + 1, EVENTSDB_RUN_MARKER_FORMAT, base, run + 1);
+	return EventsDict_Intern(&eventsdb->dict, name, length);
+}
+
+static struct markers_queue_entry *EventsDb_AddMarker(struct EventsDb *eventsdb, 
+	const char *marker)
 {
 	struct markers_queue_entry *entry;
 
 	entry = malloc(sizeof(*entry));
 	assert(NULL != entry);
-	entry->marker = marker;
+	entry->base = marker;
+	entry->run = eventsdb->run;
+	entry->marker = EventsDb_RunMarker(eventsdb, marker, eventsdb->run);
+	entry->id = eventsdb->m_queue_length++;
 	TAILQ_INSERT_TAIL(&eventsdb->m_queue, entry, entries);
+	EventsCorrelate_MarkerAdded(&eventsdb->correlate, entry->base);
+	return entry;
 }
 
 static void EventsDb_AddTime(struct EventsDb *eventsdb, const char *time)
@@ -91,32 +268,161 @@ static void EventsDb_AddTime(struct EventsDb *eventsdb, const char *time)
 	eventsdb->t_queue_length += 1;
 }
 
-static bool EventsDb_IsMarkerExists(struct EventsDb *eventsdb, const char *marker)
+static struct markers_queue_entry *EventsDb_FindMarker(struct EventsDb *eventsdb, 
+	const char *marker)
 {
 	struct markers_queue_entry *np;
 
 	for (np = eventsdb->m_queue.tqh_first; np != NULL; np = np->entries.tqe_next)
 		if (0 == strcmp(np->marker, marker))
-			return true;
-	return false;
+			return np;
+	return NULL;
 }
 
-static void EventsDb_AddEvent(struct EventsDb *eventsdb, 
-	const char *marker, const char *time, const char *message)
+/* base is interned */
+static struct markers_queue_entry *EventsDb_FindRunMarker(
+	struct EventsDb *eventsdb, const char *base, size_t run)
 {
+	struct markers_queue_entry *np;
+
+	for (np = eventsdb->m_queue.tqh_first; np != NULL; np = np->entries.tqe_next)
+		if (np->base == base && np->run == run)
+			return np;
+	return NULL;
+}
+
+/* "@ 59000" -> 59000, the first run of digits */
+static unsigned long long EventsDb_TimeValue(const char *time)
+{
+	while (*time && (*time < '0' || *time > '9'))
+		time++;
+	return strtoull(time, NULL, 10);
+}
+
+static enum EventsDb_Error EventsDb_AddEvent(struct EventsDb *eventsdb, 
+	const char *marker, const char *time, const char *message,
+	enum EventsDb_Severity severity, const char *path)
+{
+	struct EventsPaths_Node *path_node;
+	struct markers_queue_entry *marker_entry;
+	unsigned long long time_value;
+	enum EventsDb_Error err = EVENTSDB_OK;
+
 	// printf("AddEvent |%s|%s|%s|\n", time, marker, message);
 
-	if (!EventsDb_IsMarkerExists(eventsdb, marker))
-		EventsDb_AddMarker(eventsdb, marker);
+	marker_entry = EventsDb_FindRunMarker(eventsdb, marker, eventsdb->run);
+	if (NULL == marker_entry)
+		marker_entry = EventsDb_AddMarker(eventsdb, marker);
+
+	time_value = EventsDb_TimeValue(time);
+	EventsDensity_Add(&eventsdb->density, marker_entry->id, time_value);
+
+	path_node = EventsPaths_Insert(&eventsdb->paths, path);
 
-	EventsDb_AddTime(eventsdb, time);
+	if (eventsdb->out_of_core) {
+		/* The event is kept when the store fails, the load then stops
+		 * with every count including it */
+		err = EventsDb_StoreEvent(eventsdb, marker_entry, time, message,
+			severity, path_node, time_value);
+	} else {
+		EventsDb_AddTime(eventsdb, time);
+		EventsDb_AddEventBody(eventsdb, marker_entry, time, message, 
+			severity, path_node, time_value);
+	}
+	eventsdb->severity_count[severity]++;
 
-	EventsDb_AddEventBody(eventsdb, marker, time, message);
+	EventsCorrelate_Feed(&eventsdb->correlate, marker_entry->base, 
+		marker_entry->run, time_value, message);
+	return err;
 }
 
-static bool EventsDb_ParseLineValid(struct EventsDb *eventsdb, const char *buffer)
+static enum EventsDb_Severity EventsDb_ParseSeverity(const char *buffer, 
+	regmatch_t *match)
+{
+	size_t length, i;
+	const char *name;
+
+	if (-1 == match->rm_so)
+		return EVENTSDB_SEVERITY_INFO;
+
+	length = match->rm_eo - match->rm_so;
+	for (i = 0; i < EVENTSDB_SEVERITY_TOTAL; i++) {
+		name = EventsDb_SeverityNames[i];
+		if (strlen(name) == length && 
+		    0 == strncmp(name, &buffer[match->rm_so], length))
+			return i;
+	}
+	return EVENTSDB_SEVERITY_INFO;
+}
+
+/* How a line is matched, regexec is the reference for the other two */
+enum EventsDb_Route {
+	EVENTSDB_ROUTE_REGEX,
+	EVENTSDB_ROUTE_UVM,
+	EVENTSDB_ROUTE_COMPILED
+};
+
+static enum EventsDb_Route EventsDb_LineRoute(struct EventsDb *eventsdb, 
+	const char *buffer)
 {
-	return 0 == regexec(&eventsdb->regex_line_valid, buffer, 0, NULL, 0);
+	if (!eventsdb->uvm_fast_path && !eventsdb->compiled_path)
+		return EVENTSDB_ROUTE_REGEX;
+	if (eventsdb->multibyte && !EventsMatcher_Ascii(buffer))
+		return EVENTSDB_ROUTE_REGEX;
+	return eventsdb->uvm_fast_path ? 
+		EVENTSDB_ROUTE_UVM : EVENTSDB_ROUTE_COMPILED;
+}
+
+/* All the patterns in one pass, the spans are kept for the extraction */
+static bool EventsDb_ParseLineCompiled(struct EventsDb *eventsdb, 
+	const char *buffer, struct EventsMatcher_Spans *spans)
+{
+	struct EventsMatcher_Pattern *patterns[] = {
+		&eventsdb->regex_line_valid,
+		&eventsdb->regex_extract_marker,
+		&eventsdb->regex_extract_time,
+		&eventsdb->regex_extract_message,
+		eventsdb->regex_extract_path.compiled ? 
+			&eventsdb->regex_extract_path : NULL
+	};
+	regmatch_t matches[5][2];
+
+	if (!EventsMatcher_ExecSet(patterns, 5, buffer, matches))
+		return false;
+	spans->severity = matches[0][1];
+	spans->marker = matches[1][0];
+	spans->time = matches[2][0];
+	spans->message = matches[3][0];
+	spans->path = (-1 != matches[4][1].rm_so) ? matches[4][1] : matches[4][0];
+	return true;
+}
+
+static bool EventsDb_ParseLineValid(struct EventsDb *eventsdb, const char *buffer,
+	enum EventsDb_Route route, enum EventsDb_Severity *severity, 
+	struct EventsMatcher_Spans *spans)
+{
+	size_t n_match = 2;
+	regmatch_t matches[n_match];
+
+	if (EVENTSDB_ROUTE_UVM == route) {
+		if (!EventsMatcher_UvmValid(buffer, spans))
+			return false;
+		*severity = EventsDb_ParseSeverity(buffer, &spans->severity);
+		return true;
+	}
+
+	if (EVENTSDB_ROUTE_COMPILED == route) {
+		if (!EventsDb_ParseLineCompiled(eventsdb, buffer, spans))
+			return false;
+		*severity = EventsDb_ParseSeverity(buffer, &spans->severity);
+		return true;
+	}
+
+	if (!EventsMatcher_Exec(&eventsdb->regex_line_valid, buffer, 
+	    n_match, matches))
+		return false;
+	*severity = EventsDb_ParseSeverity(buffer, &matches[1]);
+	return true;
 }
 
 static void EventsDb_CleanString(char *buffer)
@@ -136,62 +442,168 @@ static void EventsDb_CleanString(char *buffer)
 	}
 }
 
-static void EventsDb_MatchToBuffer(const char *buffer, 
-	regmatch_t *result, char **result_buffer)
+/* Out of core only markers are interned, times and messages are copied to
+ * the store and live in the scratch buffer until the next line */
+static void EventsDb_MatchToBuffer(struct EventsDb *eventsdb, const char *buffer, 
+	regmatch_t *result, enum EventsDb_Field field, const char **result_buffer)
 {
 	size_t length = result->rm_eo - result->rm_so;
 	char *result_buffer_int;
 
-	result_buffer_int = malloc(length + 1);
+	result_buffer_int = EventsDb_Scratch(eventsdb, field, length + 1);
 	strncpy(result_buffer_int, &buffer[result->rm_so], length);
 	result_buffer_int[length] = 0;
 	EventsDb_CleanString(result_buffer_int);
-	*result_buffer = result_buffer_int;
+	if (eventsdb->out_of_core && EVENTSDB_FIELD_MARKER != field)
+		*result_buffer = result_buffer_int;
+	else
+		*result_buffer = EventsDict_Intern(&eventsdb->dict, 
+			result_buffer_int, length);
 }
 
-static enum EventsDb_Error EventsDb_ParseLineExtract(regex_t *expr, 
-	const char *buffer, char **result)
+static enum EventsDb_Error EventsDb_ParseLineExtract(struct EventsDb *eventsdb,
+	struct EventsMatcher_Pattern *expr, enum EventsDb_Field field,
+	const char *buffer, const char **result)
 {
-	int match_status;
 	enum EventsDb_Error err = EVENTSDB_OK;
 	size_t n_match = 1;
 	regmatch_t matches[n_match];
 
-	match_status = regexec(expr, buffer, n_match, matches, 0);
-	if (match_status) {
+	if (!EventsMatcher_Exec(expr, buffer, n_match, matches)) {
 		printf("malformed line: %s", buffer);
 		err = EVENTSDB_MALFORMED_LINE;
 		goto out;
 	}
-	EventsDb_MatchToBuffer(buffer, &matches[0], result);
+	EventsDb_MatchToBuffer(eventsdb, buffer, &matches[0], field, result);
 out:
 	return err;
 }
 
-static enum EventsDb_Error EventsDb_ParseLine(
-	struct EventsDb *eventsdb, const char *buffer)
+static char *EventsDb_MatchToPath(const char *buffer, regmatch_t *match)
+{
+	size_t length;
+	char *path;
+
+	if (-1 == match->rm_so)
+		return NULL;
+
+	length = match->rm_eo - match->rm_so;
+	path = malloc(length + 1);
+	assert(NULL != path);
+	memcpy(path, &buffer[match->rm_so], length);
+	path[length] = 0;
+	return path;
+}
+
+static char *EventsDb_ParseLinePath(struct EventsDb *eventsdb, 
+	const char *buffer)
+{
+	size_t n_match = 2;
+	regmatch_t matches[n_match];
+
+	if (!eventsdb->regex_extract_path.compiled)
+		return NULL;
+	if (!EventsMatcher_Exec(&eventsdb->regex_extract_path, buffer, 
+	    n_match, matches))
+		return NULL;
+
+	return EventsDb_MatchToPath(buffer, 
+		(-1 != matches[1].rm_so) ? &matches[1] : &matches[0]);
+}
+
+/* The spans come from the UVM scan or from EventsDb_ParseLineCompiled */
+static enum EventsDb_Error EventsDb_ParseLineSpans(struct EventsDb *eventsdb,
+	const char *buffer, enum EventsDb_Route route, 
+	struct EventsMatcher_Spans *spans, const char **marker, 
+	const char **time, const char **message, char **path)
+{
+	bool found;
+
+	if (EVENTSDB_ROUTE_UVM == route)
+		found = EVENTSMATCHER_UVM_OK == 
+			EventsMatcher_UvmExtract(buffer, spans);
+	else
+		found = -1 != spans->marker.rm_so && 
+			-1 != spans->time.rm_so && 
+			-1 != spans->message.rm_so;
+	if (!found) {
+		printf("malformed line: %s", buffer);
+		return EVENTSDB_MALFORMED_LINE;
+	}
+
+	EventsDb_MatchToBuffer(eventsdb, buffer, &spans->marker, 
+		EVENTSDB_FIELD_MARKER, marker);
+	EventsDb_MatchToBuffer(eventsdb, buffer, &spans->time, 
+		EVENTSDB_FIELD_TIME, time);
+	EventsDb_MatchToBuffer(eventsdb, buffer, &spans->message, 
+		EVENTSDB_FIELD_MESSAGE, message);
+	if (eventsdb->regex_extract_path.compiled)
+		*path = EventsDb_MatchToPath(buffer, &spans->path);
+
+	return EVENTSDB_OK;
+}
+
+static enum EventsDb_Error EventsDb_ParseLineFields(struct EventsDb *eventsdb, 
+	const char *buffer, enum EventsDb_Route route, 
+	struct EventsMatcher_Spans *spans, const char **marker, 
+	const char **time, const char **message, char **path)
 {
 	enum EventsDb_Error err;
-	char *marker = NULL;
-	char *time = NULL;
-	char *message = NULL;
 
-	if (!EventsDb_ParseLineValid(eventsdb, buffer))
-		return EVENTSDB_OK;
+	if (EVENTSDB_ROUTE_REGEX != route)
+		return EventsDb_ParseLineSpans(eventsdb, buffer, route, spans,
+			marker, time, message, path);
+
+	err = EventsDb_ParseLineExtract(eventsdb, &eventsdb->regex_extract_marker, 
+		EVENTSDB_FIELD_MARKER, buffer, marker);
+	if (err) return err;
 
-	err = EventsDb_ParseLineExtract(&eventsdb->regex_extract_marker, 
-		buffer, &marker);
+	err = EventsDb_ParseLineExtract(eventsdb, &eventsdb->regex_extract_time, 
+		EVENTSDB_FIELD_TIME, buffer, time);
 	if (err) return err;
 
-	err = EventsDb_ParseLineExtract(&eventsdb->regex_extract_time, 
-		buffer, &time);
+	err = EventsDb_ParseLineExtract(eventsdb, &eventsdb->regex_extract_message, 
+		EVENTSDB_FIELD_MESSAGE, buffer, message);
 	if (err) return err;
 
-	err = EventsDb_ParseLineExtract(&eventsdb->regex_extract_message, 
-		buffer, &message);
+	*path = EventsDb_ParseLinePath(eventsdb, buffer);
+
+	return EVENTSDB_OK;
+}
+
+static enum EventsDb_Error EventsDb_ParseLine(
+	struct EventsDb *eventsdb, const char *buffer)
+{
+	enum EventsDb_Error err;
+	const char *marker = NULL;
+	const char *time = NULL;
+	const char *message = NULL;
+	char *path = NULL;
+	enum EventsDb_Severity severity;
+	struct EventsMatcher_Spans spans;
+	enum EventsDb_Route route;
+	unsigned long long begin;
+	bool valid;
+
+	begin = EventsStats_Begin(&eventsdb->stats);
+	route = EventsDb_LineRoute(eventsdb, buffer);
+	valid = EventsDb_ParseLineValid(eventsdb, buffer, route, &severity, &spans);
+	EventsStats_End(&eventsdb->stats, EVENTSSTATS_VALIDATE, begin);
+	if (!valid)
+		return EVENTSDB_OK;
+
+	begin = EventsStats_Begin(&eventsdb->stats);
+	err = EventsDb_ParseLineFields(eventsdb, buffer, route, &spans,
+		&marker, &time, &message, &path);
+	EventsStats_End(&eventsdb->stats, EVENTSSTATS_EXTRACT, begin);
 	if (err) return err;
 
-	EventsDb_AddEvent(eventsdb, marker, time, message);
+	begin = EventsStats_Begin(&eventsdb->stats);
+	err = EventsDb_AddEvent(eventsdb, marker, time, message, severity, path);
+	EventsStats_End(&eventsdb->stats, EVENTSSTATS_INDEX, begin);
+	free(path);
+	eventsdb->stats.events++;
+	if (err) return err;
 
 	return EVENTSDB_OK;
 }
@@ -202,52 +614,589 @@ enum EventsDb_Error EventsDb_AddLog(struct EventsDb *eventsdb, const char *log_n
 	ssize_t read;
 	char *buffer;
 	size_t buffer_size = EVENTSDB_LINE_BUFFER_SIZE;
+	unsigned long long begin_load, begin;
+	enum EventsDb_Error err = EVENTSDB_OK;
 
+	begin_load = EventsStats_Begin(&eventsdb->stats);
 	log = fopen(log_name, "r");
 	if (NULL == log)
 		return EVENTSDB_CANT_OPEN;	
 
+	if (eventsdb->run_per_log && eventsdb->logs > 0)
+		eventsdb->run++;
+	eventsdb->logs++;
+	eventsdb->runs = eventsdb->run + 1;
+
 	buffer = malloc(buffer_size);
 	assert(NULL != buffer);
 	while(1) {
+		begin = EventsStats_Begin(&eventsdb->stats);
 		read = getline(&buffer, &buffer_size, log);
+		EventsStats_End(&eventsdb->stats, EVENTSSTATS_READ, begin);
 		if (-1 == read)
 			break;
-		EventsDb_ParseLine(eventsdb, buffer);
+		eventsdb->stats.lines++;
+		eventsdb->stats.bytes += read;
+		if (EVENTSDB_STORE_FAILED == EventsDb_ParseLine(eventsdb, buffer)) {
+			err = EVENTSDB_STORE_FAILED;
+			break;
+		}
 	}
 
 	fclose(log);
 	free(buffer);
+	if (eventsdb->out_of_core && EventsStore_Flush(&eventsdb->store))
+		err = EVENTSDB_STORE_FAILED;
+	EventsPaths_Reindex(&eventsdb->paths);
+	EventsStats_End(&eventsdb->stats, EVENTSSTATS_LOAD, begin_load);
+	return err;
+}
+
+/* Must be called before the first log is added, events of all logs are
+ * then kept in directory and at most memory_budget bytes of them are mapped */
+enum EventsDb_Error EventsDb_SetStore(struct EventsDb *eventsdb, 
+	const char *directory, size_t memory_budget)
+{
+	if (eventsdb->out_of_core || 0 != eventsdb->e_queue_length)
+		return EVENTSDB_STORE_FAILED;
+	if (EventsStore_Init(&eventsdb->store, directory, memory_budget))
+		return EVENTSDB_STORE_FAILED;
+	eventsdb->out_of_core = true;
 	return EVENTSDB_OK;
 }
 
+/* NULL when events are kept in memory */
+struct EventsStore *EventsDb_GetStore(struct EventsDb *eventsdb)
+{
+	return eventsdb->out_of_core ? &eventsdb->store : NULL;
+}
+
 struct markers_queue *EventsDb_GetMarkersQueue(struct EventsDb *eventsdb)
 {
 	return &eventsdb->m_queue;
 }
 
-static char *EventsDb_MarkerAtTime(struct EventsDb *eventsdb, 
-	const char *marker, const char *time, size_t enter_n)
+static struct markers_queue_entry **EventsDb_MarkersById(
+	struct EventsDb *eventsdb)
+{
+	struct markers_queue_entry *m_entry, **markers;
+
+	markers = malloc((eventsdb->m_queue_length + 1) * sizeof(*markers));
+	assert(NULL != markers);
+	for (m_entry = eventsdb->m_queue.tqh_first; m_entry != NULL; 
+	     m_entry = m_entry->entries.tqe_next)
+		markers[m_entry->id] = m_entry;
+	return markers;
+}
+
+static enum EventsDb_Error EventsDb_StoreCorrelate(struct EventsDb *eventsdb)
+{
+	struct markers_queue_entry **markers;
+	struct EventsStore_Event event;
+	enum EventsDb_Error err = EVENTSDB_OK;
+	size_t i, count;
+
+	markers = EventsDb_MarkersById(eventsdb);
+
+	count = EventsStore_Count(&eventsdb->store);
+	for (i = 0; i < count; i++) {
+		if (EventsStore_Get(&eventsdb->store, i, &event)) {
+			err = EVENTSDB_STORE_FAILED;
+			break;
+		}
+		EventsCorrelate_Feed(&eventsdb->correlate, 
+			markers[event.marker]->base, markers[event.marker]->run,
+			event.time, event.message);
+	}
+
+	free(markers);
+	return err;
+}
+
+/* Events already loaded are joined in one pass, later logs are joined
+ * while they are ingested. Markers are matched by their name in the log,
+ * the events of each run are paired within the run */
+enum EventsDb_Error EventsDb_SetCorrelation(struct EventsDb *eventsdb,
+	const char *from_marker, const char *from_pattern,
+	const char *to_marker, const char *to_pattern)
+{
+	struct markers_queue_entry *m_entry, **markers;
+	struct events_queue_entry *e_entry;
+	struct EventsCorrelate *correlate = &eventsdb->correlate;
+
+	if (EventsCorrelate_Setup(correlate, from_marker, from_pattern,
+	    to_marker, to_pattern))
+		return EVENTSDB_PATTERN_EXTRACT_WRONG;
+
+	for (m_entry = eventsdb->m_queue.tqh_first; m_entry != NULL; 
+	     m_entry = m_entry->entries.tqe_next)
+		EventsCorrelate_MarkerAdded(correlate, m_entry->base);
+
+	if (eventsdb->out_of_core)
+		return EventsDb_StoreCorrelate(eventsdb);
+
+	markers = EventsDb_MarkersById(eventsdb);
+	for (e_entry = eventsdb->e_queue.tqh_first; e_entry != NULL; 
+	     e_entry = e_entry->entries.tqe_next)
+		EventsCorrelate_Feed(correlate, markers[e_entry->marker_id]->base,
+			markers[e_entry->marker_id]->run, e_entry->time_value, 
+			e_entry->message);
+	free(markers);
+
+	return EVENTSDB_OK;
+}
+
+struct EventsCorrelate *EventsDb_GetCorrelate(struct EventsDb *eventsdb)
+{
+	return &eventsdb->correlate;
+}
+
+/* With run_per_log every log added after the first one is a new run */
+void EventsDb_SetRunPerLog(struct EventsDb *eventsdb, bool run_per_log)
+{
+	eventsdb->run_per_log = run_per_log;
+}
+
+size_t EventsDb_RunsCount(struct EventsDb *eventsdb)
+{
+	return eventsdb->runs;
+}
+
+/* Tokens of the events of one marker in the log order */
+struct EventsDb_Sequence {
+	uint64_t *tokens;
+	size_t *events;
+	size_t length;
+	size_t capacity;
+};
+
+static void EventsDb_SequenceAppend(struct EventsDb_Sequence *sequence, 
+	uint64_t token, size_t event)
+{
+	if (sequence->length == sequence->capacity) {
+		sequence->capacity = sequence->capacity ? 
+			sequence->capacity * 2 : EVENTSDB_INDEX_INITIAL_SIZE;
+		sequence->tokens = realloc(sequence->tokens, 
+			sequence->capacity * sizeof(*sequence->tokens));
+		assert(NULL != sequence->tokens);
+		sequence->events = realloc(sequence->events, 
+			sequence->capacity * sizeof(*sequence->events));
+		assert(NULL != sequence->events);
+	}
+	sequence->tokens[sequence->length] = token;
+	sequence->events[sequence->length] = event;
+	sequence->length++;
+}
+
+/* Interned messages are their own tokens, stored ones are hashed */
+static enum EventsDb_Error EventsDb_DiffSequences(struct EventsDb *eventsdb,
+	struct markers_queue_entry **markers, struct EventsDb_Sequence *sequences)
 {
 	struct events_queue_entry *np;
-	size_t same_counter = 0;
+	struct EventsStore_Event event;
+	size_t i, count, run;
+
+	if (!eventsdb->out_of_core) {
+		for (np = eventsdb->e_queue.tqh_first; np != NULL; 
+		     np = np->entries.tqe_next) {
+			run = markers[np->marker_id]->run;
+			if (run == eventsdb->diff_runs[0] || 
+			    run == eventsdb->diff_runs[1])
+				EventsDb_SequenceAppend(&sequences[np->marker_id],
+					(uintptr_t)np->message, np->index);
+		}
+		return EVENTSDB_OK;
+	}
 
-	for (np = eventsdb->e_queue.tqh_first; np != NULL; np = np->entries.tqe_next)
-		if (0 == strcmp(np->marker, marker) && 
-		    0 == strcmp(np->time, time)) 
-		{
-			if (0 == enter_n) 
-			{
-				return (char *)np->message;
-			} else {
-				if (same_counter == enter_n)
-					return (char *)np->message;
-				same_counter++;
-			}
+	count = EventsStore_Count(&eventsdb->store);
+	for (i = 0; i < count; i++) {
+		if (EventsStore_Get(&eventsdb->store, i, &event))
+			return EVENTSDB_STORE_FAILED;
+		run = markers[event.marker]->run;
+		if (run == eventsdb->diff_runs[0] || run == eventsdb->diff_runs[1])
+			EventsDb_SequenceAppend(&sequences[event.marker],
+				EventsDiff_Hash(event.message), i);
+	}
+	return EVENTSDB_OK;
+}
+
+static char *EventsDb_StringCopy(const char *string)
+{
+	char *copy;
+
+	copy = strdup(string);
+	assert(NULL != copy);
+	return copy;
+}
+
+/* Time and message of the event at index */
+static void EventsDb_DiffEvent(struct EventsDb *eventsdb, size_t index, 
+	char **time, char **message)
+{
+	struct events_queue_entry *entry;
+	struct EventsStore_Event event;
+	size_t s;
+
+	if (eventsdb->out_of_core) {
+		if (EventsStore_Get(&eventsdb->store, index, &event))
+			return;
+		*time = EventsDb_StringCopy(event.time_text);
+		*message = EventsDb_StringCopy(event.message);
+		return;
+	}
+
+	for (s = 0; s < EVENTSDB_SEVERITY_TOTAL; s++) {
+		entry = EventsDb_SeverityNext(eventsdb, s, index);
+		if (NULL == entry || entry->index != index)
+			continue;
+		*time = EventsDb_StringCopy(entry->time);
+		*message = EventsDb_StringCopy(entry->message);
+		return;
+	}
+}
+
+static void EventsDb_DiffFree(struct EventsDb *eventsdb)
+{
+	size_t i, side;
+
+	for (i = 0; i < eventsdb->diffs_count; i++)
+		for (side = 0; side < 2; side++) {
+			free(eventsdb->diffs[i].time[side]);
+			free(eventsdb->diffs[i].message[side]);
+		}
+	free(eventsdb->diffs);
+	eventsdb->diffs = NULL;
+	eventsdb->diffs_count = 0;
+}
+
+static void EventsDb_DiffMarker(struct EventsDb *eventsdb, 
+	struct EventsDiff *diff, struct EventsDb_Sequence *sequences,
+	struct markers_queue_entry *entry_a, struct markers_queue_entry *entry_b)
+{
+	struct EventsDb_MarkerDiff *marker_diff;
+	struct EventsDb_Sequence empty, *sequence[2];
+	size_t side;
+
+	memset(&empty, 0, sizeof(empty));
+	marker_diff = &eventsdb->diffs[eventsdb->diffs_count++];
+	memset(marker_diff, 0, sizeof(*marker_diff));
+	marker_diff->entry[0] = entry_a;
+	marker_diff->entry[1] = entry_b;
+	marker_diff->base = (NULL != entry_a) ? entry_a->base : entry_b->base;
+
+	for (side = 0; side < 2; side++)
+		sequence[side] = (NULL != marker_diff->entry[side]) ?
+			&sequences[marker_diff->entry[side]->id] : &empty;
+	EventsDiff_Align(diff, sequence[0]->tokens, sequence[0]->length,
+		sequence[1]->tokens, sequence[1]->length, &marker_diff->result);
+
+	for (side = 0; side < 2; side++) {
+		marker_diff->event[side] = EVENTSDB_NONE;
+		if (marker_diff->result.equal || 
+		    marker_diff->result.first >= sequence[side]->length)
+			continue;
+		marker_diff->event[side] = 
+			sequence[side]->events[marker_diff->result.first];
+		EventsDb_DiffEvent(eventsdb, marker_diff->event[side],
+			&marker_diff->time[side], &marker_diff->message[side]);
+	}
+}
+
+/* Events of every marker are aligned by their messages between the runs,
+ * markers found in one run only are aligned with nothing. The alignment 
+ * ignores times, the tables show the runs side by side by time */
+enum EventsDb_Error EventsDb_DiffRuns(struct EventsDb *eventsdb, 
+	size_t run_a, size_t run_b)
+{
+	struct markers_queue_entry *np, *partner, **markers;
+	struct EventsDb_Sequence *sequences;
+	struct EventsDiff diff;
+	enum EventsDb_Error err;
+	size_t i;
+
+	EventsDb_DiffFree(eventsdb);
+	eventsdb->diff_runs[0] = run_a;
+	eventsdb->diff_runs[1] = run_b;
+
+	markers = EventsDb_MarkersById(eventsdb);
+	sequences = calloc(eventsdb->m_queue_length + 1, sizeof(*sequences));
+	assert(NULL != sequences);
+	eventsdb->diffs = calloc(eventsdb->m_queue_length + 1, 
+		sizeof(*eventsdb->diffs));
+	assert(NULL != eventsdb->diffs);
+
+	err = EventsDb_DiffSequences(eventsdb, markers, sequences);
+	if (err) goto out;
+
+	EventsDiff_Init(&diff);
+	for (np = eventsdb->m_queue.tqh_first; np != NULL; np = np->entries.tqe_next) {
+		if (np->run == run_a) {
+			partner = EventsDb_FindRunMarker(eventsdb, np->base, run_b);
+			EventsDb_DiffMarker(eventsdb, &diff, sequences, np, partner);
+		} else if (np->run == run_b && 
+			   NULL == EventsDb_FindRunMarker(eventsdb, np->base, run_a))
+			EventsDb_DiffMarker(eventsdb, &diff, sequences, NULL, np);
+	}
+	EventsDiff_Done(&diff);
+
+out:
+	for (i = 0; i < eventsdb->m_queue_length; i++) {
+		free(sequences[i].tokens);
+		free(sequences[i].events);
+	}
+	free(sequences);
+	free(markers);
+	return err;
+}
+
+size_t EventsDb_DiffCount(struct EventsDb *eventsdb)
+{
+	return eventsdb->diffs_count;
+}
+
+struct EventsDb_MarkerDiff *EventsDb_DiffAt(struct EventsDb *eventsdb, 
+	size_t n)
+{
+	assert(n < eventsdb->diffs_count);
+	return &eventsdb->diffs[n];
+}
+
+/* Diff of a marker as named in the markers queue, side tells its run */
+struct EventsDb_MarkerDiff *EventsDb_DiffFind(struct EventsDb *eventsdb, 
+	const char *marker, size_t *side)
+{
+	struct markers_queue_entry *entry;
+	size_t i;
+
+	for (i = 0; i < eventsdb->diffs_count; i++)
+		for (*side = 0; *side < 2; (*side)++) {
+			entry = eventsdb->diffs[i].entry[*side];
+			if (NULL != entry && 0 == strcmp(entry->marker, marker))
+				return &eventsdb->diffs[i];
 		}
 	return NULL;
 }
 
+void EventsDb_DiffPrint(struct EventsDb *eventsdb, FILE *output)
+{
+	struct EventsDb_MarkerDiff *marker_diff;
+	struct EventsDiff_Result *result;
+	size_t i, side, differ = 0;
+
+	for (i = 0; i < eventsdb->diffs_count; i++)
+		if (!eventsdb->diffs[i].result.equal)
+			differ++;
+	if (0 == eventsdb->diffs_count)
+		return;
+	fprintf(output, "run %zu -> run %zu: %zu of %zu markers differ\n",
+		eventsdb->diff_runs[0] + 1, eventsdb->diff_runs[1] + 1, 
+		differ, eventsdb->diffs_count);
+
+	for (i = 0; i < eventsdb->diffs_count; i++) {
+		marker_diff = &eventsdb->diffs[i];
+		result = &marker_diff->result;
+		if (result->equal)
+			continue;
+		fprintf(output, "%s: %zu -> %zu events, %zu%s common, "
+			"first divergence after %zu\n", marker_diff->base, 
+			result->length_a, result->length_b, result->common, 
+			result->exact ? "" : " or more", result->first);
+		for (side = 0; side < 2; side++)
+			if (NULL != marker_diff->time[side])
+				fprintf(output, "  run %zu %s:%s\n", 
+					eventsdb->diff_runs[side] + 1,
+					marker_diff->time[side], 
+					marker_diff->message[side]);
+	}
+}
+
+struct EventsDict *EventsDb_GetDict(struct EventsDb *eventsdb)
+{
+	return &eventsdb->dict;
+}
+
+struct EventsStats *EventsDb_GetStats(struct EventsDb *eventsdb)
+{
+	return &eventsdb->stats;
+}
+
+const char *EventsDb_SeverityName(enum EventsDb_Severity severity)
+{
+	assert(severity < EVENTSDB_SEVERITY_TOTAL);
+	return EventsDb_SeverityNames[severity];
+}
+
+size_t EventsDb_SeverityCount(struct EventsDb *eventsdb, 
+	enum EventsDb_Severity severity)
+{
+	assert(severity < EVENTSDB_SEVERITY_TOTAL);
+	return eventsdb->severity_count[severity];
+}
+
+/* Severity indexes are empty out of core */
+struct events_queue_entry *EventsDb_SeverityEventAt(struct EventsDb *eventsdb, 
+	enum EventsDb_Severity severity, size_t n)
+{
+	assert(severity < EVENTSDB_SEVERITY_TOTAL);
+	assert(n < eventsdb->severity_index[severity].length);
+	return eventsdb->severity_index[severity].entries[n];
+}
+
+/* Position of the first entry with index >= event_index */
+static size_t EventsDb_IndexLowerBound(struct events_index *index, 
+	size_t event_index)
+{
+	size_t low = 0, high = index->length, middle;
+
+	while (low < high) {
+		middle = low + (high - low) / 2;
+		if (index->entries[middle]->index < event_index)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	return low;
+}
+
+struct events_queue_entry *EventsDb_SeverityNext(struct EventsDb *eventsdb, 
+	enum EventsDb_Severity severity, size_t event_index)
+{
+	struct events_index *index;
+	size_t position;
+
+	assert(severity < EVENTSDB_SEVERITY_TOTAL);
+	index = &eventsdb->severity_index[severity];
+	position = EventsDb_IndexLowerBound(index, event_index);
+	if (position == index->length)
+		return NULL;
+	return index->entries[position];
+}
+
+struct events_queue_entry *EventsDb_SeverityPrevious(struct EventsDb *eventsdb, 
+	enum EventsDb_Severity severity, size_t event_index)
+{
+	struct events_index *index;
+	size_t position;
+
+	assert(severity < EVENTSDB_SEVERITY_TOTAL);
+	index = &eventsdb->severity_index[severity];
+	position = EventsDb_IndexLowerBound(index, event_index);
+	if (0 == position)
+		return NULL;
+	return index->entries[position - 1];
+}
+
+struct EventsPaths *EventsDb_GetPaths(struct EventsDb *eventsdb)
+{
+	return &eventsdb->paths;
+}
+
+size_t EventsDb_DensityLevels(__attribute__((unused))struct EventsDb *eventsdb)
+{
+	return EVENTSDENSITY_LEVELS;
+}
+
+/* Buckets of the level that hold events, the rest are empty */
+size_t EventsDb_DensityBuckets(struct EventsDb *eventsdb, size_t level)
+{
+	return EventsDensity_UsedBuckets(&eventsdb->density, level);
+}
+
+unsigned long long EventsDb_DensityBucketWidth(struct EventsDb *eventsdb, 
+	size_t level)
+{
+	return EventsDensity_BucketWidth(&eventsdb->density, level);
+}
+
+/* Events of the markers of the table, of all markers when it has none. 
+ * Densities are counted per marker only, the severity and path filters 
+ * don't apply: the strip shows what the log holds */
+unsigned int EventsDb_ResponseDensityAt(struct EventsDb *eventsdb, 
+	size_t level, size_t bucket)
+{
+	struct markers_queue_entry *marker_entry;
+	unsigned int count = 0;
+	size_t i;
+
+	if (!eventsdb->response_valid || 0 == eventsdb->response_markers_count)
+		return EventsDensity_GetTotal(&eventsdb->density, level, bucket);
+
+	for (i = 0; i < eventsdb->response_markers_count; i++) {
+		marker_entry = eventsdb->response_marker_entries[i];
+		if (NULL != marker_entry)
+			count += EventsDensity_Get(&eventsdb->density, 
+				marker_entry->id, level, bucket);
+	}
+	return count;
+}
+
+unsigned int EventsDb_GetSeverityMask(struct EventsDb *eventsdb)
+{
+	return eventsdb->severity_mask;
+}
+
+void EventsDb_SetSeverityMask(struct EventsDb *eventsdb, unsigned int mask)
+{
+	eventsdb->severity_mask = mask & EVENTSDB_SEVERITY_MASK_ALL;
+}
+
+bool EventsDb_IsWindowed(struct EventsDb *eventsdb)
+{
+	return eventsdb->out_of_core;
+}
+
+size_t EventsDb_EventsCount(struct EventsDb *eventsdb)
+{
+	return eventsdb->e_queue_length;
+}
+
+/* First event in the log order at or after time */
+size_t EventsDb_EventAtTime(struct EventsDb *eventsdb, unsigned long long time)
+{
+	struct events_queue_entry *np;
+
+	if (eventsdb->out_of_core)
+		return EventsStore_FindTime(&eventsdb->store, time);
+
+	for (np = eventsdb->e_queue.tqh_first; np != NULL; np = np->entries.tqe_next)
+		if (np->time_value >= time)
+			return np->index;
+	return eventsdb->e_queue_length;
+}
+
+/* Out of core the next table starts at first_event, in memory tables 
+ * always hold every event. The runs are stored one after another, out of
+ * core their rows are not merged by time */
+void EventsDb_SetWindow(struct EventsDb *eventsdb, size_t first_event)
+{
+	eventsdb->window_first = first_event;
+	eventsdb->window_backward = false;
+}
+
+/* The next table ends right before last_event, paging back from a window
+ * that started there leaves no gap and no overlap */
+void EventsDb_SetWindowBefore(struct EventsDb *eventsdb, size_t last_event)
+{
+	eventsdb->window_last = last_event;
+	eventsdb->window_backward = true;
+}
+
+size_t EventsDb_WindowFirst(struct EventsDb *eventsdb)
+{
+	return eventsdb->response_first;
+}
+
+size_t EventsDb_WindowLast(struct EventsDb *eventsdb)
+{
+	return eventsdb->response_last;
+}
+
+static bool EventsDb_SeverityEnabled(struct EventsDb *eventsdb, 
+	unsigned char severity)
+{
+	return 0 != (eventsdb->severity_mask & (1u << severity));
+}
+
 enum EventsDb_Error EventsDb_ResponseAllocateMemory(struct EventsDb *eventsdb, 
 	size_t markers_length)
 {
@@ -265,77 +1214,342 @@ enum EventsDb_Error EventsDb_ResponseAllocateMemory(struct EventsDb *eventsdb,
 	return EVENTSDB_OK;
 }
 
-static char *EventsDb_GetStubMessage(void)
+static char *EventsDb_GetStubMessage(struct EventsDb *eventsdb)
+{
+	return (char *)EventsDict_Intern(&eventsdb->dict, " ", 1);
+}
+
+/* The row of the first diverging event of a marker is kept for the view */
+static void EventsDb_ResponseSetCell(struct EventsDb *eventsdb, size_t row,
+	size_t marker, const char *message, size_t event)
 {
-	char *stub_str;
+	size_t table_i = row * eventsdb->response_columns + marker + 1;
 
-	stub_str = malloc(2);
-	assert(NULL != stub_str);
-	stub_str[0] = ' ';
-	stub_str[1] = '\0';
-	return stub_str;
+	eventsdb->response[table_i] = (char *)message;
+	if (EVENTSDB_NONE != event &&
+	    event == eventsdb->response_diverging_event[marker] &&
+	    EVENTSDB_NONE == eventsdb->response_diverging_row[marker])
+		eventsdb->response_diverging_row[marker] = row;
 }
 
-static bool EventsDb_ResponseContentOneLine(struct EventsDb *eventsdb,
-	char *markers[], size_t markers_length, 
-	struct time_queue_entry *np, size_t current_row, size_t enter_n)
+static struct events_queue_entry *EventsDb_RowCursorEvent(
+	struct EventsDb *eventsdb, struct EventsDb_RowCursor *cursor)
 {
-	size_t i, table_i;
-	bool all_null = true;
-	char *message;
+	struct events_queue_entry *entry, *next;
+	struct events_index *index;
+	size_t s, next_s;
+
+	do {
+		if (EVENTSDB_SEVERITY_MASK_ALL == eventsdb->severity_mask) {
+			next = cursor->np;
+			if (NULL == next)
+				return NULL;
+			cursor->np = next->entries.tqe_next;
+			continue;
+		}
 
-	if (0 == markers_length)
-		goto out;
+		next = NULL;
+		next_s = 0;
+		for (s = 0; s < EVENTSDB_SEVERITY_TOTAL; s++) {
+			if (!EventsDb_SeverityEnabled(eventsdb, s))
+				continue;
+			index = &eventsdb->severity_index[s];
+			if (cursor->position[s] >= index->length)
+				continue;
+			entry = index->entries[cursor->position[s]];
+			if (NULL == next || entry->index < next->index) {
+				next = entry;
+				next_s = s;
+			}
+		}
+		if (NULL == next)
+			return NULL;
+		cursor->position[next_s]++;
+	} while (cursor->markers[next->marker_id]->run != cursor->run);
+	return next;
+}
 
-	for (i = 0; i < markers_length; i++) {
-		message = EventsDb_MarkerAtTime(eventsdb, markers[i], np->time, enter_n);
-		table_i = current_row * eventsdb->response_columns + i + 1;
-		if (NULL != message) {
-			eventsdb->response[table_i] = message;
-			all_null = false;
-		} else
-			message = EventsDb_GetStubMessage();
-		assert(message != NULL);
-		eventsdb->response[table_i] = message;
+/* Moves to the next group of equal times of the run and keeps its events */
+static void EventsDb_RowCursorGroup(struct EventsDb *eventsdb, 
+	struct EventsDb_RowCursor *cursor)
+{
+	cursor->time = NULL;
+	cursor->count = 0;
+	if (NULL == cursor->next)
+		return;
+
+	cursor->time = cursor->next->time;
+	cursor->time_value = cursor->next->time_value;
+	while (NULL != cursor->next && cursor->next->time == cursor->time) {
+		if (cursor->count == cursor->capacity) {
+			cursor->capacity = cursor->capacity ? 
+				cursor->capacity * 2 : EVENTSDB_INDEX_INITIAL_SIZE;
+			cursor->group = realloc(cursor->group, 
+				cursor->capacity * sizeof(*cursor->group));
+			assert(NULL != cursor->group);
+		}
+		cursor->group[cursor->count++] = cursor->next;
+		cursor->next = EventsDb_RowCursorEvent(eventsdb, cursor);
 	}
+}
 
-out:
-	return all_null;
+static void EventsDb_RowCursorInit(struct EventsDb *eventsdb, 
+	struct EventsDb_RowCursor *cursor, size_t run,
+	struct markers_queue_entry **markers)
+{
+	memset(cursor, 0, sizeof(*cursor));
+	cursor->np = eventsdb->e_queue.tqh_first;
+	cursor->run = run;
+	cursor->markers = markers;
+	cursor->next = EventsDb_RowCursorEvent(eventsdb, cursor);
+	EventsDb_RowCursorGroup(eventsdb, cursor);
 }
 
+static void EventsDb_ResponseRowInit(struct EventsDb *eventsdb, size_t row, 
+	const char *time)
+{
+	char **cells = &eventsdb->response[row * eventsdb->response_columns];
+	size_t i;
+
+	cells[0] = (char *)time;
+	for (i = 1; i < eventsdb->response_columns; i++)
+		cells[i] = EventsDb_GetStubMessage(eventsdb);
+}
+
+/* Column of every marker id, -1 for markers the table doesn't show */
+static int *EventsDb_ResponseColumns(struct EventsDb *eventsdb, 
+	size_t markers_length)
+{
+	struct markers_queue_entry *m_entry;
+	int *column_of;
+	size_t i;
+
+	column_of = malloc((eventsdb->m_queue_length + 1) * sizeof(*column_of));
+	assert(NULL != column_of);
+	for (i = 0; i < eventsdb->m_queue_length; i++)
+		column_of[i] = -1;
+	for (i = 0; i < markers_length; i++) {
+		m_entry = eventsdb->response_marker_entries[i];
+		if (NULL != m_entry)
+			column_of[m_entry->id] = i;
+	}
+	return column_of;
+}
+
+/* Groups of equal times of every run are merged by time. The k-th row of a
+ * time holds the k-th visible event of each marker of every run within 
+ * the groups, which are filled in one pass; without markers a time takes
+ * one row per event of its largest group */
 static enum EventsDb_Error EventsDb_ResponseContent(struct EventsDb *eventsdb, 
-	char *markers[], size_t markers_length)
+	size_t markers_length)
 {
-	struct time_queue_entry *np;
-	size_t j, table_i;
-	bool all_null;
-	const char *previous_time = "";
-	size_t same_counter = 0;
+	struct EventsDb_RowCursor *cursors, *first;
+	struct markers_queue_entry **markers_by_id;
+	struct events_queue_entry *entry;
+	const char *time;
+	size_t *counts, i, r, rows, group_rows, row;
 	size_t response_rows_limit;
+	int *column_of, column;
+
+	markers_by_id = EventsDb_MarkersById(eventsdb);
+	column_of = EventsDb_ResponseColumns(eventsdb, markers_length);
+	counts = calloc(markers_length + 1, sizeof(*counts));
+	assert(NULL != counts);
+	cursors = calloc(eventsdb->runs + 1, sizeof(*cursors));
+	assert(NULL != cursors);
+	for (r = 0; r < eventsdb->runs; r++)
+		EventsDb_RowCursorInit(eventsdb, &cursors[r], r, markers_by_id);
 
 	response_rows_limit = eventsdb->response_rows;
 	eventsdb->response_rows = 0;
-	for (np = eventsdb->t_queue.tqh_first, j = 0; np != NULL; 
-	     np = np->entries.tqe_next) {
-		if (0 == strcmp(np->time, previous_time))
-			same_counter += 1;
-		else
-			same_counter = 0;
-		all_null = EventsDb_ResponseContentOneLine(eventsdb, 
-			markers, markers_length, np, j, same_counter);
-		if (!all_null || 0 == markers_length) {
-			table_i = j * eventsdb->response_columns;
-			eventsdb->response[table_i] = (char *)np->time;
-			j++;
-			assert(eventsdb->response_rows < response_rows_limit);
-			eventsdb->response_rows++;
+	while (1) {
+		first = NULL;
+		for (r = 0; r < eventsdb->runs; r++)
+			if (NULL != cursors[r].time && (NULL == first ||
+			    cursors[r].time_value < first->time_value))
+				first = &cursors[r];
+		if (NULL == first)
+			break;
+
+		time = first->time;
+		group_rows = 0;
+		for (r = 0; r < eventsdb->runs; r++)
+			if (cursors[r].time == time && cursors[r].count > group_rows)
+				group_rows = cursors[r].count;
+		assert(eventsdb->response_rows + group_rows <= 
+			response_rows_limit);
+		for (row = 0; row < group_rows; row++)
+			EventsDb_ResponseRowInit(eventsdb, 
+				eventsdb->response_rows + row, time);
+
+		rows = 0;
+		memset(counts, 0, markers_length * sizeof(*counts));
+		for (r = 0; r < eventsdb->runs; r++) {
+			if (cursors[r].time != time)
+				continue;
+			for (i = 0; i < cursors[r].count; i++) {
+				entry = cursors[r].group[i];
+				column = column_of[entry->marker_id];
+				if (!entry->path->enabled || -1 == column)
+					continue;
+				row = eventsdb->response_rows + counts[column]++;
+				EventsDb_ResponseSetCell(eventsdb, row, column, 
+					entry->message, entry->index);
+				if (counts[column] > rows)
+					rows = counts[column];
+			}
+			EventsDb_RowCursorGroup(eventsdb, &cursors[r]);
+		}
+		eventsdb->response_rows += markers_length ? rows : group_rows;
+	}
+
+	for (r = 0; r < eventsdb->runs; r++)
+		free(cursors[r].group);
+	free(cursors);
+	free(counts);
+	free(column_of);
+	free(markers_by_id);
+	return EVENTSDB_OK;
+}
+
+/* Both events have the same time text, a is kept mapped while b is read */
+static int EventsDb_StoreSameTime(struct EventsDb *eventsdb, size_t a, size_t b,
+	bool *same)
+{
+	struct EventsStore *store = &eventsdb->store;
+	struct EventsStore_Event event_a, event_b;
+	int err;
+
+	if (EventsStore_Get(store, a, &event_a))
+		return -1;
+	EventsStore_Pin(store, a, a + 1);
+	err = EventsStore_Get(store, b, &event_b);
+	if (!err)
+		*same = event_a.time == event_b.time &&
+			0 == strcmp(event_a.time_text, event_b.time_text);
+	EventsStore_Unpin(store, a, a + 1);
+	return err;
+}
+
+/* Events [first, last) of the window. The time run at its far edge is 
+ * taken whole while the window stays within twice its size and half of 
+ * the budget, longer runs are split across windows */
+static enum EventsDb_Error EventsDb_StoreWindow(struct EventsDb *eventsdb,
+	size_t *first, size_t *last)
+{
+	struct EventsStore *store = &eventsdb->store;
+	size_t count = EventsStore_Count(store);
+	size_t edge;
+	bool same = true;
+
+	if (eventsdb->window_backward) {
+		*last = eventsdb->window_last < count ? 
+			eventsdb->window_last : count;
+		*first = EventsStore_WindowStart(store, *last, 
+			EVENTSDB_WINDOW_EVENTS);
+		edge = EventsStore_WindowStart(store, *last, 
+			2 * EVENTSDB_WINDOW_EVENTS);
+		while (*first > edge && *first < *last && same) {
+			if (EventsDb_StoreSameTime(eventsdb, *first, *first - 1, 
+			    &same))
+				return EVENTSDB_STORE_FAILED;
+			if (same)
+				(*first)--;
 		}
-		previous_time = np->time;
+		return EVENTSDB_OK;
 	}
 
+	*first = eventsdb->window_first < count ? eventsdb->window_first : count;
+	*last = EventsStore_WindowEnd(store, *first, EVENTSDB_WINDOW_EVENTS);
+	edge = EventsStore_WindowEnd(store, *first, 2 * EVENTSDB_WINDOW_EVENTS);
+	while (*last < edge && *last > *first && same) {
+		if (EventsDb_StoreSameTime(eventsdb, *last - 1, *last, &same))
+			return EVENTSDB_STORE_FAILED;
+		if (same)
+			(*last)++;
+	}
 	return EVENTSDB_OK;
 }
 
+/* Same rows as EventsDb_ResponseContent for one run: the k-th row of a 
+ * run of equal times takes the k-th visible event of each marker within
+ * the run. Runs are not merged and a run split by the window edge gives
+ * its rows in both windows */
+static enum EventsDb_Error EventsDb_ResponseContentWindow(
+	struct EventsDb *eventsdb, size_t markers_length, size_t first, 
+	size_t last)
+{
+	struct EventsStore_Event event;
+	struct EventsPaths_Node *path;
+	const char *run_time = NULL;
+	size_t *run_counts, run_length = 0, run_rows = 0;
+	int *column_of;
+	size_t e, row;
+	int column;
+
+	column_of = EventsDb_ResponseColumns(eventsdb, markers_length);
+	run_counts = calloc(markers_length + 1, sizeof(*run_counts));
+	assert(NULL != run_counts);
+
+	eventsdb->response_rows = 0;
+	for (e = first; e < last; e++) {
+		if (EventsStore_Get(&eventsdb->store, e, &event))
+			break;
+		if (!EventsDb_SeverityEnabled(eventsdb, event.severity))
+			continue;
+
+		if (NULL == run_time || 0 != strcmp(run_time, event.time_text)) {
+			eventsdb->response_rows += markers_length ? 
+				run_rows : run_length;
+			run_time = event.time_text;
+			run_length = 0;
+			run_rows = 0;
+			memset(run_counts, 0, markers_length * sizeof(*run_counts));
+		}
+		EventsDb_ResponseRowInit(eventsdb, 
+			eventsdb->response_rows + run_length, run_time);
+		run_length++;
+
+		path = EventsPaths_GetNode(&eventsdb->paths, event.path);
+		column = column_of[event.marker];
+		if (!path->enabled || -1 == column)
+			continue;
+		row = eventsdb->response_rows + run_counts[column]++;
+		EventsDb_ResponseSetCell(eventsdb, row, column, event.message, e);
+		if (run_counts[column] > run_rows)
+			run_rows = run_counts[column];
+	}
+	eventsdb->response_rows += markers_length ? run_rows : run_length;
+
+	free(run_counts);
+	free(column_of);
+	return e < last ? EVENTSDB_STORE_FAILED : EVENTSDB_OK;
+}
+
+static enum EventsDb_Error EventsDb_RequestEventsWindow(
+	struct EventsDb *eventsdb, size_t markers_length)
+{
+	enum EventsDb_Error err;
+	size_t first, last;
+
+	err = EventsDb_StoreWindow(eventsdb, &first, &last);
+	if (err) return err;
+
+	eventsdb->response_columns = markers_length + 1;
+	eventsdb->response_rows = last - first;
+	eventsdb->response = malloc((eventsdb->response_rows + 1) * 
+		eventsdb->response_columns * sizeof(char *));
+	if (NULL == eventsdb->response)
+		return EVENTSDB_NOT_ENOUGHT_MEM;
+
+	/* Cells point into the segments of the window */
+	EventsStore_Pin(&eventsdb->store, first, last);
+	eventsdb->response_first = first;
+	eventsdb->response_last = last;
+	return EventsDb_ResponseContentWindow(eventsdb, markers_length, 
+		first, last);
+}
+
 enum EventsDb_Error EventsDb_ResponseCopyMarkers(struct EventsDb *eventsdb,
 	char *markers[], size_t markers_length)
 {
@@ -346,30 +1560,86 @@ enum EventsDb_Error EventsDb_ResponseCopyMarkers(struct EventsDb *eventsdb,
 	eventsdb->response_markers = malloc(markers_size);
 	if (NULL == eventsdb->response_markers)
 		return EVENTSDB_NOT_ENOUGHT_MEM;
+	eventsdb->response_marker_entries = malloc(markers_length * 
+		sizeof(*eventsdb->response_marker_entries));
+	if (NULL == eventsdb->response_marker_entries)
+		return EVENTSDB_NOT_ENOUGHT_MEM;
 	
-	for (i = 0; i < markers_length; i++)
-		eventsdb->response_markers[i] = markers[i];
+	/* Names the log doesn't have stay out of the dict and match nothing */
+	for (i = 0; i < markers_length; i++) {
+		eventsdb->response_markers[i] = (char *)EventsDict_Find(
+			&eventsdb->dict, markers[i], strlen(markers[i]));
+		eventsdb->response_marker_entries[i] = 
+			NULL != eventsdb->response_markers[i] ?
+			EventsDb_FindMarker(eventsdb, markers[i]) : NULL;
+	}
 
 	return EVENTSDB_OK;
 }
 
-enum EventsDb_Error EventsDb_RequestEventsTable(struct EventsDb *eventsdb, 
-	char *markers[], size_t markers_length)
+static void EventsDb_ResponseDiverging(struct EventsDb *eventsdb,
+	size_t markers_length)
+{
+	struct EventsDb_MarkerDiff *diff;
+	size_t i, side;
+
+	eventsdb->response_diverging_event = malloc((markers_length + 1) * 
+		sizeof(*eventsdb->response_diverging_event));
+	assert(NULL != eventsdb->response_diverging_event);
+	eventsdb->response_diverging_row = malloc((markers_length + 1) * 
+		sizeof(*eventsdb->response_diverging_row));
+	assert(NULL != eventsdb->response_diverging_row);
+
+	for (i = 0; i < markers_length; i++) {
+		diff = NULL != eventsdb->response_markers[i] ? 
+			EventsDb_DiffFind(eventsdb, 
+				eventsdb->response_markers[i], &side) : NULL;
+		eventsdb->response_diverging_event[i] = (NULL != diff) ? 
+			diff->event[side] : EVENTSDB_NONE;
+		eventsdb->response_diverging_row[i] = EVENTSDB_NONE;
+	}
+}
+
+static enum EventsDb_Error EventsDb_RequestEventsTableBody(
+	struct EventsDb *eventsdb, char *markers[], size_t markers_length)
 {
 	enum EventsDb_Error err;
 
+	/* A failed request still leaves a response for ResponseFreeMemory */
+	EventsDb_ResponseFreeMemory(eventsdb);
+	eventsdb->response = NULL;
+	eventsdb->response_markers = NULL;
+	eventsdb->response_marker_entries = NULL;
+	eventsdb->response_diverging_event = NULL;
+	eventsdb->response_diverging_row = NULL;
+	eventsdb->response_valid = true;
+
 	err = EventsDb_ResponseCopyMarkers(eventsdb, markers, markers_length);
 	if (err) return err;
+	EventsDb_ResponseDiverging(eventsdb, markers_length);
+
+	if (eventsdb->out_of_core)
+		return EventsDb_RequestEventsWindow(eventsdb, markers_length);
 
+	eventsdb->response_first = 0;
+	eventsdb->response_last = eventsdb->e_queue_length;
 	err = EventsDb_ResponseAllocateMemory(eventsdb, markers_length);
 	if (err) return err;
 
-	err = EventsDb_ResponseContent(eventsdb, markers, markers_length);
-	if (err) return err;
+	return EventsDb_ResponseContent(eventsdb, markers_length);
+}
 
-	eventsdb->response_valid = true;
+enum EventsDb_Error EventsDb_RequestEventsTable(struct EventsDb *eventsdb, 
+	char *markers[], size_t markers_length)
+{
+	enum EventsDb_Error err;
+	unsigned long long begin;
 
-	return EVENTSDB_OK;
+	begin = EventsStats_Begin(&eventsdb->stats);
+	err = EventsDb_RequestEventsTableBody(eventsdb, markers, markers_length);
+	EventsStats_End(&eventsdb->stats, EVENTSSTATS_TABLE, begin);
+
+	return err;
 }
 
 char *EventsDb_ResponseGetValueAt(struct EventsDb *eventsdb, size_t column, size_t row)
@@ -392,6 +1662,7 @@ size_t EventsDb_ResponseGetRows(struct EventsDb *eventsdb)
 	return eventsdb->response_rows;
 }
 
+/* NULL for a requested marker the log doesn't have */
 char *EventsDb_ResponseMarkerAt(struct EventsDb *eventsdb, size_t index)
 {
 	assert(index < eventsdb->response_markers_count);
@@ -403,20 +1674,95 @@ size_t EventsDb_ResponseMarkersCount(struct EventsDb *eventsdb)
 	return eventsdb->response_markers_count;
 }
 
+/* Row of the first event of the marker at index that diverges between the
+ * diffed runs, EVENTSDB_NONE when the table does not show it */
+size_t EventsDb_ResponseDivergingRow(struct EventsDb *eventsdb, size_t index)
+{
+	assert(index < eventsdb->response_markers_count);
+	return eventsdb->response_diverging_row[index];
+}
+
+/* First row at or after time, rows follow the log order */
+size_t EventsDb_ResponseRowAtTime(struct EventsDb *eventsdb, 
+	unsigned long long time)
+{
+	size_t low = 0, high = eventsdb->response_rows, middle;
+	const char *row_time;
+
+	while (low < high) {
+		middle = low + (high - low) / 2;
+		row_time = EventsDb_ResponseGetValueAt(eventsdb, 0, middle);
+		if (EventsDb_TimeValue(row_time) < time)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	return low;
+}
+
 void EventsDb_ResponseFreeMemory(struct EventsDb *eventsdb)
 {
 	if(!eventsdb->response_valid)
 		return;
 
+	if (eventsdb->out_of_core)
+		EventsStore_Unpin(&eventsdb->store, eventsdb->response_first,
+			eventsdb->response_last);
+	eventsdb->response_first = eventsdb->response_last = 0;
+	eventsdb->response_rows = eventsdb->response_columns = 0;
+	eventsdb->response_markers_count = 0;
 	free(eventsdb->response);
 	free(eventsdb->response_markers);
+	free(eventsdb->response_marker_entries);
+	free(eventsdb->response_diverging_event);
+	free(eventsdb->response_diverging_row);
 	eventsdb->response_valid = false;
 }
 
-void EventsDb_Done(__attribute__((unused))struct EventsDb *eventsdb)
+/* Strings of the entries belong to the dict */
+static void EventsDb_FreeQueues(struct EventsDb *eventsdb)
+{
+	struct markers_queue_entry *m_entry;
+	struct time_queue_entry *t_entry;
+	struct events_queue_entry *e_entry;
+
+	while (NULL != (m_entry = eventsdb->m_queue.tqh_first)) {
+		TAILQ_REMOVE(&eventsdb->m_queue, m_entry, entries);
+		free(m_entry);
+	}
+	while (NULL != (t_entry = eventsdb->t_queue.tqh_first)) {
+		TAILQ_REMOVE(&eventsdb->t_queue, t_entry, entries);
+		free(t_entry);
+	}
+	while (NULL != (e_entry = eventsdb->e_queue.tqh_first)) {
+		TAILQ_REMOVE(&eventsdb->e_queue, e_entry, entries);
+		free(e_entry);
+	}
+}
+
+void EventsDb_Done(struct EventsDb *eventsdb)
 {
-	/* TODO: free memory for all stored events */
-	/* regfree */
-	/* result */
+	size_t i;
+
+	/* The response pins store segments and points into the dict */
+	EventsDb_ResponseFreeMemory(eventsdb);
+	for (i = 0; i < EVENTSDB_SEVERITY_TOTAL; i++)
+		EventsDb_IndexFree(&eventsdb->severity_index[i]);
+	EventsPaths_Done(&eventsdb->paths);
+	EventsDensity_Done(&eventsdb->density);
+	EventsStats_Done(&eventsdb->stats);
+	EventsCorrelate_Done(&eventsdb->correlate);
+	EventsDb_DiffFree(eventsdb);
+	EventsDict_Done(&eventsdb->dict);
+	if (eventsdb->out_of_core)
+		EventsStore_Done(&eventsdb->store);
+	for (i = 0; i < EVENTSDB_FIELD_TOTAL; i++)
+		free(eventsdb->scratch[i]);
+	EventsMatcher_Free(&eventsdb->regex_line_valid);
+	EventsMatcher_Free(&eventsdb->regex_extract_marker);
+	EventsMatcher_Free(&eventsdb->regex_extract_time);
+	EventsMatcher_Free(&eventsdb->regex_extract_message);
+	EventsMatcher_Free(&eventsdb->regex_extract_path);
+	EventsDb_FreeQueues(eventsdb);
 }
 
@@ -5,11 +5,32 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <sys/queue.h>
+#include "events_correlate.h"
+#include "events_density.h"
+#include "events_dict.h"
+#include "events_diff.h"
+#include "events_matcher.h"
+#include "events_paths.h"
+#include "events_stats.h"
+#include "events_store.h"
 
-#define EVENTSDB_PATTERN_LINE_VALID      "^UVM_INFO.*@.*"
+#define EVENTSDB_PATTERN_LINE_VALID      "^UVM_\\(INFO\\|WARNING\\|ERROR\\|FATAL\\) .*@.*"
 #define EVENTSDB_PATTERN_EXTRACT_MARKER  "\\[.*\\]"
 #define EVENTSDB_PATTERN_EXTRACT_TIME    "@ [0-9]*"
 #define EVENTSDB_PATTERN_EXTRACT_MESSAGE "\\].*$"
+/* Component path, the first capture group is taken when present */
+#define EVENTSDB_PATTERN_EXTRACT_PATH    ": ([^ []+) \\["
+
+/* No event or no row */
+#define EVENTSDB_NONE ((size_t)-1)
+
+/* Markers of the runs after the first one are shown as "name(run 2)" */
+#define EVENTSDB_RUN_MARKER_FORMAT "%s(run %zu)"
+
+/* Events of one out-of-core table, the last time run is completed */
+#ifndef EVENTSDB_WINDOW_EVENTS
+#define EVENTSDB_WINDOW_EVENTS (64 * 1024)
+#endif
 
 enum EventsDb_Error{
 	EVENTSDB_OK,
@@ -17,13 +38,36 @@ enum EventsDb_Error{
 	EVENTSDB_MALFORMED_LINE,
 	EVENTSDB_PATTERN_LINE_VALID_WRONG,
 	EVENTSDB_PATTERN_EXTRACT_WRONG,
-	EVENTSDB_NOT_ENOUGHT_MEM
+	EVENTSDB_NOT_ENOUGHT_MEM,
+	EVENTSDB_STORE_FAILED
+};
+
+/* First capture group of the line valid pattern names the severity */
+enum EventsDb_Severity{
+	EVENTSDB_SEVERITY_INFO,
+	EVENTSDB_SEVERITY_WARNING,
+	EVENTSDB_SEVERITY_ERROR,
+	EVENTSDB_SEVERITY_FATAL,
+	EVENTSDB_SEVERITY_TOTAL
+};
+
+#define EVENTSDB_SEVERITY_MASK_ALL ((1u << EVENTSDB_SEVERITY_TOTAL) - 1)
+
+/* Extracted fields, each one has its own scratch buffer */
+enum EventsDb_Field{
+	EVENTSDB_FIELD_MARKER,
+	EVENTSDB_FIELD_TIME,
+	EVENTSDB_FIELD_MESSAGE,
+	EVENTSDB_FIELD_TOTAL
 };
 
 TAILQ_HEAD(markers_queue, markers_queue_entry);
 struct markers_queue_entry {
 	TAILQ_ENTRY(markers_queue_entry) entries;
 	const char *marker;
+	size_t id;
+	const char *base;	/* marker as extracted from the log */
+	size_t run;
 };
 
 TAILQ_HEAD(time_queue, time_queue_entry);
@@ -38,18 +82,92 @@ struct events_queue_entry {
 	const char *marker;
 	const char *time;
 	const char *message;
+	unsigned long long time_value;
+	size_t index;
+	size_t marker_id;
+	unsigned char severity; /* enum EventsDb_Severity */
+	struct EventsPaths_Node *path;
+};
+
+/* Events of one kind in ingestion order, sorted by events_queue_entry.index */
+struct events_index {
+	struct events_queue_entry **entries;
+	size_t length;
+	size_t capacity;
+};
+
+/* Alignment of the events of one marker in two runs, side 0 is the first
+ * run. The messages of the marker are aligned in the log order, times are
+ * not compared: the first diverging event of a side is the first one of 
+ * its sequence past the common prefix. Its index, time and message are
+ * EVENTSDB_NONE and NULL when that side ended before */
+struct EventsDb_MarkerDiff {
+	const char *base;
+	struct markers_queue_entry *entry[2];
+	struct EventsDiff_Result result;
+	size_t event[2];
+	char *time[2];
+	char *message[2];
 };
 
 struct EventsDb {
-	regex_t regex_line_valid;
-	regex_t regex_extract_marker;
-	regex_t regex_extract_time;
-	regex_t regex_extract_message;
+	struct EventsMatcher_Pattern regex_line_valid;
+	struct EventsMatcher_Pattern regex_extract_marker;
+	struct EventsMatcher_Pattern regex_extract_time;
+	struct EventsMatcher_Pattern regex_extract_message;
+	struct EventsMatcher_Pattern regex_extract_path;
+	/* Default patterns are matched by EventsMatcher_Uvm* in one scan */
+	bool uvm_fast_path;
+	/* Every pattern has an automaton, EventsMatcher_ExecSet runs them */
+	bool compiled_path;
+	/* Patterns compiled in a multibyte locale, where regexec reads bytes 
+	 * above 0x7f as characters: such lines skip both scanners */
+	bool multibyte;
 
 	struct markers_queue m_queue;
+	size_t m_queue_length;
 	struct time_queue t_queue;
 	int t_queue_length;
 	struct events_queue e_queue;
+	/* Out of core counts the stored events, the unsealed ones too */
+	size_t e_queue_length;
+
+	struct events_index severity_index[EVENTSDB_SEVERITY_TOTAL];
+	size_t severity_count[EVENTSDB_SEVERITY_TOTAL];
+	unsigned int severity_mask;
+
+	struct EventsPaths paths;
+
+	/* Per marker event counts in time buckets, series id is the marker id */
+	struct EventsDensity density;
+
+	struct EventsStats stats;
+
+	struct EventsCorrelate correlate;
+
+	/* Events are tagged with the run of their log, markers of each run
+	 * are separate */
+	size_t run;
+	size_t runs;
+	bool run_per_log;
+	size_t logs;
+	struct EventsDb_MarkerDiff *diffs;
+	size_t diffs_count;
+	size_t diff_runs[2];
+
+	/* Owns every marker, time and message string held in memory */
+	struct EventsDict dict;
+	char *scratch[EVENTSDB_FIELD_TOTAL];
+	size_t scratch_size[EVENTSDB_FIELD_TOTAL];
+
+	/* Out-of-core mode: events go to the store instead of e_queue and
+	 * t_queue, tables cover the events from window_first on or, when
+	 * window_backward, the events before window_last */
+	bool out_of_core;
+	struct EventsStore store;
+	size_t window_first;
+	size_t window_last;
+	bool window_backward;
 
 	bool response_valid;
 
@@ -59,6 +177,17 @@ struct EventsDb {
 
 	char **response_markers;
 	size_t response_markers_count;
+	/* Resolved once per table, NULL for names the log doesn't have */
+	struct markers_queue_entry **response_marker_entries;
+
+	/* Per marker of the response: its first diverging event in the runs
+	 * diff and the row that shows it */
+	size_t *response_diverging_event;
+	size_t *response_diverging_row;
+
+	/* Events the response was built from, pinned out of core */
+	size_t response_first;
+	size_t response_last;
 };
 
 enum EventsDb_Error EventsDb_Init(struct EventsDb *eventsdb);
@@ -71,10 +200,67 @@ enum EventsDb_Error EventsDb_NewPatterns(struct EventsDb *eventsdb,
 	const char *pattern_extract_time,
 	const char *pattern_extract_message);
 
+enum EventsDb_Error EventsDb_NewPathPattern(struct EventsDb *eventsdb,
+	const char *pattern_extract_path);
+
+enum EventsDb_Error EventsDb_SetStore(struct EventsDb *eventsdb, 
+	const char *directory, size_t memory_budget);
+struct EventsStore *EventsDb_GetStore(struct EventsDb *eventsdb);
+
 enum EventsDb_Error EventsDb_AddLog(struct EventsDb *eventsdb, const char *log_name);
 
 struct markers_queue *EventsDb_GetMarkersQueue(struct EventsDb *eventsdb);
 
+enum EventsDb_Error EventsDb_SetCorrelation(struct EventsDb *eventsdb,
+	const char *from_marker, const char *from_pattern,
+	const char *to_marker, const char *to_pattern);
+struct EventsCorrelate *EventsDb_GetCorrelate(struct EventsDb *eventsdb);
+
+void EventsDb_SetRunPerLog(struct EventsDb *eventsdb, bool run_per_log);
+size_t EventsDb_RunsCount(struct EventsDb *eventsdb);
+enum EventsDb_Error EventsDb_DiffRuns(struct EventsDb *eventsdb, 
+	size_t run_a, size_t run_b);
+size_t EventsDb_DiffCount(struct EventsDb *eventsdb);
+struct EventsDb_MarkerDiff *EventsDb_DiffAt(struct EventsDb *eventsdb, 
+	size_t n);
+struct EventsDb_MarkerDiff *EventsDb_DiffFind(struct EventsDb *eventsdb, 
+	const char *marker, size_t *side);
+void EventsDb_DiffPrint(struct EventsDb *eventsdb, FILE *output);
+
+struct EventsDict *EventsDb_GetDict(struct EventsDb *eventsdb);
+struct EventsStats *EventsDb_GetStats(struct EventsDb *eventsdb);
+
+const char *EventsDb_SeverityName(enum EventsDb_Severity severity);
+size_t EventsDb_SeverityCount(struct EventsDb *eventsdb, 
+	enum EventsDb_Severity severity);
+struct events_queue_entry *EventsDb_SeverityEventAt(struct EventsDb *eventsdb, 
+	enum EventsDb_Severity severity, size_t n);
+struct events_queue_entry *EventsDb_SeverityNext(struct EventsDb *eventsdb, 
+	enum EventsDb_Severity severity, size_t event_index);
+struct events_queue_entry *EventsDb_SeverityPrevious(struct EventsDb *eventsdb, 
+	enum EventsDb_Severity severity, size_t event_index);
+
+struct EventsPaths *EventsDb_GetPaths(struct EventsDb *eventsdb);
+
+size_t EventsDb_DensityLevels(struct EventsDb *eventsdb);
+size_t EventsDb_DensityBuckets(struct EventsDb *eventsdb, size_t level);
+unsigned long long EventsDb_DensityBucketWidth(struct EventsDb *eventsdb, 
+	size_t level);
+unsigned int EventsDb_ResponseDensityAt(struct EventsDb *eventsdb, 
+	size_t level, size_t bucket);
+
+unsigned int EventsDb_GetSeverityMask(struct EventsDb *eventsdb);
+void EventsDb_SetSeverityMask(struct EventsDb *eventsdb, unsigned int mask);
+
+bool EventsDb_IsWindowed(struct EventsDb *eventsdb);
+size_t EventsDb_EventsCount(struct EventsDb *eventsdb);
+size_t EventsDb_EventAtTime(struct EventsDb *eventsdb, unsigned long long time);
+void EventsDb_SetWindow(struct EventsDb *eventsdb, size_t first_event);
+
+void EventsDb_SetWindowBefore(struct EventsDb *eventsdb, size_t last_event);
+size_t EventsDb_WindowFirst(struct EventsDb *eventsdb);
+size_t EventsDb_WindowLast(struct EventsDb *eventsdb);
+
 
 enum EventsDb_Error EventsDb_RequestEventsTable(struct EventsDb *eventsdb, 
 	char *markers[], size_t markers_length);
@@ -85,6 +271,9 @@ char *EventsDb_ResponseMarkerAt(struct EventsDb *eventsdb, size_t index);
 size_t EventsDb_ResponseGetColumns(struct EventsDb *eventsdb);
 size_t EventsDb_ResponseGetRows(struct EventsDb *eventsdb);
 size_t EventsDb_ResponseMarkersCount(struct EventsDb *eventsdb);
+size_t EventsDb_ResponseDivergingRow(struct EventsDb *eventsdb, size_t index);
+size_t EventsDb_ResponseRowAtTime(struct EventsDb *eventsdb, 
+	unsigned long long time);
 void EventsDb_ResponseFreeMemory(struct EventsDb *eventsdb);
 
 #endif
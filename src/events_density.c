@@ -0,0 +1,146 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "events_density.h"
+
+#define EVENTSDENSITY_COUNTS (2 * EVENTSDENSITY_BUCKETS - 1)
+
+void EventsDensity_Init(struct EventsDensity *density)
+{
+	memset(density, 0, sizeof(*density));
+	density->bucket_width = EVENTSDENSITY_INITIAL_WIDTH;
+	density->total = calloc(EVENTSDENSITY_COUNTS, sizeof(*density->total));
+	assert(NULL != density->total);
+}
+
+void EventsDensity_Done(struct EventsDensity *density)
+{
+	size_t i;
+
+	for (i = 0; i < density->series_count; i++)
+		free(density->series[i]);
+	free(density->series);
+	free(density->total);
+	memset(density, 0, sizeof(*density));
+}
+
+size_t EventsDensity_LevelBuckets(size_t level)
+{
+	assert(level < EVENTSDENSITY_LEVELS);
+	return EVENTSDENSITY_BUCKETS >> level;
+}
+
+static size_t EventsDensity_LevelOffset(size_t level)
+{
+	return 2 * EVENTSDENSITY_BUCKETS - (2 * EVENTSDENSITY_BUCKETS >> level);
+}
+
+/* Doubling the bucket width turns level l + 1 into level l */
+static void EventsDensity_RescaleCounts(unsigned int *counts)
+{
+	size_t level, offset, buckets;
+
+	for (level = 0; level + 1 < EVENTSDENSITY_LEVELS; level++) {
+		offset = EventsDensity_LevelOffset(level);
+		buckets = EventsDensity_LevelBuckets(level);
+		memmove(&counts[offset], 
+			&counts[EventsDensity_LevelOffset(level + 1)],
+			buckets / 2 * sizeof(*counts));
+		memset(&counts[offset + buckets / 2], 0, 
+			buckets / 2 * sizeof(*counts));
+	}
+}
+
+static void EventsDensity_Rescale(struct EventsDensity *density)
+{
+	size_t i;
+
+	for (i = 0; i < density->series_count; i++)
+		if (NULL != density->series[i])
+			EventsDensity_RescaleCounts(density->series[i]);
+	EventsDensity_RescaleCounts(density->total);
+	density->bucket_width *= 2;
+}
+
+static unsigned int *EventsDensity_Series(struct EventsDensity *density, 
+	size_t series)
+{
+	size_t capacity;
+
+	if (series >= density->series_capacity) {
+		capacity = density->series_capacity ? 
+			density->series_capacity : 16;
+		while (capacity <= series)
+			capacity *= 2;
+		density->series = realloc(density->series, 
+			capacity * sizeof(*density->series));
+		assert(NULL != density->series);
+		memset(&density->series[density->series_capacity], 0, 
+			(capacity - density->series_capacity) * 
+			sizeof(*density->series));
+		density->series_capacity = capacity;
+	}
+	if (series >= density->series_count)
+		density->series_count = series + 1;
+
+	if (NULL == density->series[series]) {
+		density->series[series] = calloc(EVENTSDENSITY_COUNTS, 
+			sizeof(*density->series[series]));
+		assert(NULL != density->series[series]);
+	}
+	return density->series[series];
+}
+
+static void EventsDensity_Increment(unsigned int *counts, size_t bucket)
+{
+	size_t level;
+
+	for (level = 0; level < EVENTSDENSITY_LEVELS; level++)
+		counts[EventsDensity_LevelOffset(level) + (bucket >> level)]++;
+}
+
+void EventsDensity_Add(struct EventsDensity *density, size_t series, 
+	unsigned long long time)
+{
+	unsigned int *counts;
+	size_t bucket;
+
+	counts = EventsDensity_Series(density, series);
+	while (time / density->bucket_width >= EVENTSDENSITY_BUCKETS)
+		EventsDensity_Rescale(density);
+
+	bucket = time / density->bucket_width;
+	EventsDensity_Increment(counts, bucket);
+	EventsDensity_Increment(density->total, bucket);
+
+	if (time > density->time_max)
+		density->time_max = time;
+}
+
+size_t EventsDensity_UsedBuckets(struct EventsDensity *density, size_t level)
+{
+	return (density->time_max / density->bucket_width >> level) + 1;
+}
+
+unsigned long long EventsDensity_BucketWidth(struct EventsDensity *density, 
+	size_t level)
+{
+	assert(level < EVENTSDENSITY_LEVELS);
+	return density->bucket_width << level;
+}
+
+unsigned int EventsDensity_Get(struct EventsDensity *density, size_t series, 
+	size_t level, size_t bucket)
+{
+	assert(bucket < EventsDensity_LevelBuckets(level));
+	if (series >= density->series_count || NULL == density->series[series])
+		return 0;
+	return density->series[series][EventsDensity_LevelOffset(level) + bucket];
+}
+
+unsigned int EventsDensity_GetTotal(struct EventsDensity *density, 
+	size_t level, size_t bucket)
+{
+	assert(bucket < EventsDensity_LevelBuckets(level));
+	return density->total[EventsDensity_LevelOffset(level) + bucket];
+}
@@ -0,0 +1,44 @@
+#ifndef __EVENTS_DENSITY__
+#define __EVENTS_DENSITY__
+
+#include <stddef.h>
+
+/* Level 0 has EVENTSDENSITY_BUCKETS buckets, every next level halves it */
+#define EVENTSDENSITY_BUCKETS 4096
+#define EVENTSDENSITY_LEVELS  13
+#define EVENTSDENSITY_INITIAL_WIDTH 1ULL
+
+/* Counts of all levels of one series in a single array, see
+ * EventsDensity_LevelOffset */
+struct EventsDensity {
+	unsigned long long bucket_width;
+	unsigned long long time_max;
+
+	unsigned int **series;
+	size_t series_count;
+	size_t series_capacity;
+
+	unsigned int *total;
+};
+
+void EventsDensity_Init(struct EventsDensity *density);
+
+void EventsDensity_Done(struct EventsDensity *density);
+
+void EventsDensity_Add(struct EventsDensity *density, size_t series, 
+	unsigned long long time);
+
+size_t EventsDensity_LevelBuckets(size_t level);
+
+size_t EventsDensity_UsedBuckets(struct EventsDensity *density, size_t level);
+
+unsigned long long EventsDensity_BucketWidth(struct EventsDensity *density, 
+	size_t level);
+
+unsigned int EventsDensity_Get(struct EventsDensity *density, size_t series, 
+	size_t level, size_t bucket);
+
+unsigned int EventsDensity_GetTotal(struct EventsDensity *density, 
+	size_t level, size_t bucket);
+
+#endif
@@ -0,0 +1,176 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "events_dict.h"
+
+#define EVENTSDICT_SLOTS_INITIAL_SIZE 1024
+
+void EventsDict_Init(struct EventsDict *dict)
+{
+	memset(dict, 0, sizeof(*dict));
+}
+
+void EventsDict_Done(struct EventsDict *dict)
+{
+	struct EventsDict_Block *block, *next;
+
+	for (block = dict->blocks; block != NULL; block = next) {
+		next = block->next;
+		free(block);
+	}
+	free(dict->slots);
+	EventsDict_Init(dict);
+}
+
+static uint32_t EventsDict_Hash(const char *string, size_t length)
+{
+	uint32_t hash = 2166136261u;
+	size_t i;
+
+	for (i = 0; i < length; i++) {
+		hash ^= (unsigned char)string[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+static struct EventsDict_Slot *EventsDict_Lookup(struct EventsDict_Slot *slots,
+	size_t slots_size, const char *string, size_t length, uint32_t hash)
+{
+	struct EventsDict_Slot *slot;
+	size_t i;
+
+	for (i = hash & (slots_size - 1); ; i = (i + 1) & (slots_size - 1)) {
+		slot = &slots[i];
+		if (NULL == slot->string)
+			return slot;
+		if (slot->hash == hash && slot->length == length &&
+		    0 == memcmp(slot->string, string, length))
+			return slot;
+	}
+}
+
+static void EventsDict_Grow(struct EventsDict *dict)
+{
+	struct EventsDict_Slot *slots, *slot, *old;
+	size_t slots_size, i;
+
+	slots_size = dict->slots_size ? 
+		dict->slots_size * 2 : EVENTSDICT_SLOTS_INITIAL_SIZE;
+	slots = calloc(slots_size, sizeof(*slots));
+	assert(NULL != slots);
+
+	for (i = 0; i < dict->slots_size; i++) {
+		old = &dict->slots[i];
+		if (NULL == old->string)
+			continue;
+		slot = EventsDict_Lookup(slots, slots_size, 
+			old->string, old->length, old->hash);
+		*slot = *old;
+	}
+	free(dict->slots);
+	dict->slots = slots;
+	dict->slots_size = slots_size;
+}
+
+static struct EventsDict_Block *EventsDict_NewBlock(struct EventsDict *dict,
+	size_t block_size)
+{
+	struct EventsDict_Block *block;
+
+	block = malloc(sizeof(*block) + block_size);
+	assert(NULL != block);
+	block->used = 0;
+	block->size = block_size;
+	block->next = dict->blocks;
+	dict->blocks = block;
+	dict->blocks_bytes += block_size;
+	return block;
+}
+
+/* Strings longer than a quarter of a block get a block of their size, 
+ * the others go to the first partial block they fit in */
+static char *EventsDict_Allocate(struct EventsDict *dict, size_t size)
+{
+	struct EventsDict_Block *block = NULL;
+	size_t i, fullest = 0;
+
+	dict->strings_bytes += size;
+	if (size > EVENTSDICT_BLOCK_SIZE / 4) {
+		block = EventsDict_NewBlock(dict, size);
+		block->used = size;
+		return block->data;
+	}
+
+	for (i = 0; i < dict->partial_count && NULL == block; i++)
+		if (dict->partial[i]->size - dict->partial[i]->used >= size)
+			block = dict->partial[i];
+
+	if (NULL == block) {
+		if (EVENTSDICT_PARTIAL_BLOCKS == dict->partial_count) {
+			for (i = 1; i < dict->partial_count; i++)
+				if (dict->partial[i]->used > 
+				    dict->partial[fullest]->used)
+					fullest = i;
+			dict->partial[fullest] = 
+				dict->partial[--dict->partial_count];
+		}
+		block = EventsDict_NewBlock(dict, EVENTSDICT_BLOCK_SIZE);
+		dict->partial[dict->partial_count++] = block;
+	}
+
+	block->used += size;
+	return &block->data[block->used - size];
+}
+
+const char *EventsDict_Intern(struct EventsDict *dict, const char *string, 
+	size_t length)
+{
+	struct EventsDict_Slot *slot;
+	uint32_t hash;
+	char *copy;
+
+	if (2 * (dict->slots_used + 1) > dict->slots_size)
+		EventsDict_Grow(dict);
+
+	dict->references++;
+	dict->references_bytes += length + 1;
+
+	hash = EventsDict_Hash(string, length);
+	slot = EventsDict_Lookup(dict->slots, dict->slots_size, 
+		string, length, hash);
+	if (NULL != slot->string)
+		return slot->string;
+
+	copy = EventsDict_Allocate(dict, length + 1);
+	memcpy(copy, string, length);
+	copy[length] = 0;
+
+	slot->string = copy;
+	slot->length = length;
+	slot->hash = hash;
+	dict->slots_used++;
+
+	return copy;
+}
+
+/* The interned copy of string, NULL when the dict doesn't hold it */
+const char *EventsDict_Find(struct EventsDict *dict, const char *string, 
+	size_t length)
+{
+	struct EventsDict_Slot *slot;
+
+	if (0 == dict->slots_size)
+		return NULL;
+	slot = EventsDict_Lookup(dict->slots, dict->slots_size, string, length,
+		EventsDict_Hash(string, length));
+	return slot->string;
+}
+
+void EventsDict_Print(struct EventsDict *dict, FILE *output)
+{
+	fprintf(output, "strings %zu unique of %zu, "
+		"%zu bytes in blocks, %zu used, for %zu bytes referenced\n",
+		dict->slots_used, dict->references, dict->blocks_bytes, 
+		dict->strings_bytes, dict->references_bytes);
+}
@@ -0,0 +1,54 @@
+#ifndef __EVENTS_DICT__
+#define __EVENTS_DICT__
+
+#include <stdint.h>
+#include <stdio.h>
+
+/* Strings are packed into blocks of this size, longer ones get their own */
+#define EVENTSDICT_BLOCK_SIZE (64 * 1024)
+/* Blocks still taking strings, the fullest is left when a new one is needed */
+#define EVENTSDICT_PARTIAL_BLOCKS 8
+
+struct EventsDict_Block {
+	struct EventsDict_Block *next;
+	size_t used;
+	size_t size;
+	char data[];
+};
+
+struct EventsDict_Slot {
+	const char *string;
+	size_t length;
+	uint32_t hash;
+};
+
+/* Hash-consing string store: equal strings share one copy, so interned
+ * strings are equal if and only if their pointers are */
+struct EventsDict {
+	struct EventsDict_Slot *slots;
+	size_t slots_used;
+	size_t slots_size;
+
+	struct EventsDict_Block *blocks;
+	size_t blocks_bytes;
+	size_t strings_bytes;	/* used in the blocks */
+	struct EventsDict_Block *partial[EVENTSDICT_PARTIAL_BLOCKS];
+	size_t partial_count;
+
+	size_t references;
+	size_t references_bytes;
+};
+
+void EventsDict_Init(struct EventsDict *dict);
+
+void EventsDict_Done(struct EventsDict *dict);
+
+const char *EventsDict_Intern(struct EventsDict *dict, const char *string, 
+	size_t length);
+
+const char *EventsDict_Find(struct EventsDict *dict, const char *string, 
+	size_t length);
+
+void EventsDict_Print(struct EventsDict *dict, FILE *output);
+
+#endif
@@ -0,0 +1,136 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "events_diff.h"
+
+#define EVENTSDIFF_NONE (-1L)
+
+void EventsDiff_Init(struct EventsDiff *diff)
+{
+	diff->v_size = 2 * EVENTSDIFF_BAND + 3;
+	diff->v = malloc(diff->v_size * sizeof(*diff->v));
+	assert(NULL != diff->v);
+}
+
+void EventsDiff_Done(struct EventsDiff *diff)
+{
+	free(diff->v);
+	memset(diff, 0, sizeof(*diff));
+}
+
+/* Token of a string that is not interned, FNV-1a */
+uint64_t EventsDiff_Hash(const char *string)
+{
+	uint64_t hash = 14695981039346656037ULL;
+
+	while (*string) {
+		hash ^= (unsigned char)*string++;
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+/* Forward pass of Myers' O(ND) algorithm limited to EVENTSDIFF_BAND edits.
+ * The last window must reach the end of both sequences, the others stop
+ * at the end of either one. Returns false when the band ran out, x and y
+ * are then the furthest point reached with d edits */
+static bool EventsDiff_Window(struct EventsDiff *diff, const uint64_t *a,
+	size_t n, const uint64_t *b, size_t m, bool last,
+	size_t *x_end, size_t *y_end, size_t *d_end)
+{
+	long *v = diff->v + EVENTSDIFF_BAND + 1;
+	long d, k, x, y, down, right, best = -1;
+
+	v[1] = 0;
+	for (d = 0; d <= EVENTSDIFF_BAND; d++) {
+		for (k = -d; k <= d; k += 2) {
+			/* down keeps x, right moves it, both must stay inside */
+			down = (k == d || (0 == d && 0 == k)) ?
+				EVENTSDIFF_NONE : v[k + 1];
+			if (EVENTSDIFF_NONE != down && down - k > (long)m)
+				down = EVENTSDIFF_NONE;
+			right = (k == -d) ? EVENTSDIFF_NONE : v[k - 1];
+			if (EVENTSDIFF_NONE != right &&
+			    (right + 1 > (long)n || right + 1 - k < 0))
+				right = EVENTSDIFF_NONE;
+			else if (EVENTSDIFF_NONE != right)
+				right++;
+
+			if (0 == d)
+				x = 0;
+			else if (EVENTSDIFF_NONE == down && EVENTSDIFF_NONE == right) {
+				v[k] = EVENTSDIFF_NONE;
+				continue;
+			} else
+				x = (down >= right) ? down : right;
+			y = x - k;
+
+			while (x < (long)n && y < (long)m && a[x] == b[y]) {
+				x++;
+				y++;
+			}
+			v[k] = x;
+
+			if ((last && x == (long)n && y == (long)m) ||
+			    (!last && (x == (long)n || y == (long)m))) {
+				*x_end = x;
+				*y_end = y;
+				*d_end = d;
+				return true;
+			}
+			if (d == EVENTSDIFF_BAND && x + y > best) {
+				best = x + y;
+				*x_end = x;
+				*y_end = y;
+				*d_end = d;
+			}
+		}
+	}
+	return false;
+}
+
+/* Common prefix and suffix are stripped, the middle is aligned window by
+ * window with memory bounded by the band whatever the lengths are */
+void EventsDiff_Align(struct EventsDiff *diff, const uint64_t *a,
+	size_t length_a, const uint64_t *b, size_t length_b,
+	struct EventsDiff_Result *result)
+{
+	size_t prefix = 0, suffix = 0, i, j, end_a, end_b;
+	size_t window_a, window_b, x = 0, y = 0, d = 0;
+	bool last;
+
+	memset(result, 0, sizeof(*result));
+	result->length_a = length_a;
+	result->length_b = length_b;
+	result->exact = true;
+
+	while (prefix < length_a && prefix < length_b && a[prefix] == b[prefix])
+		prefix++;
+	result->first = prefix;
+	result->equal = (prefix == length_a && prefix == length_b);
+
+	while (suffix < length_a - prefix && suffix < length_b - prefix &&
+	       a[length_a - 1 - suffix] == b[length_b - 1 - suffix])
+		suffix++;
+	result->common = prefix + suffix;
+
+	i = j = prefix;
+	end_a = length_a - suffix;
+	end_b = length_b - suffix;
+	while (i < end_a && j < end_b) {
+		window_a = (end_a - i > EVENTSDIFF_WINDOW) ?
+			EVENTSDIFF_WINDOW : end_a - i;
+		window_b = (end_b - j > EVENTSDIFF_WINDOW) ?
+			EVENTSDIFF_WINDOW : end_b - j;
+		last = (i + window_a == end_a && j + window_b == end_b);
+		if (!last)
+			result->exact = false;
+
+		if (!EventsDiff_Window(diff, &a[i], window_a, &b[j], window_b,
+		    last, &x, &y, &d))
+			result->exact = false;
+		result->common += (x + y - d) / 2;
+		i += x;
+		j += y;
+	}
+}
@@ -0,0 +1,38 @@
+#ifndef __EVENTS_DIFF__
+#define __EVENTS_DIFF__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Edits explored per window before the best reached point is taken */
+#define EVENTSDIFF_BAND   1024
+/* Tokens of each sequence aligned at once */
+#define EVENTSDIFF_WINDOW (64 * 1024)
+
+struct EventsDiff_Result {
+	size_t length_a;
+	size_t length_b;
+	size_t common;	/* aligned equal tokens */
+	size_t first;	/* tokens before the first divergence */
+	bool equal;
+	bool exact;	/* common is the LCS length, a lower bound otherwise */
+};
+
+/* Furthest reaching x of every diagonal, reused across alignments */
+struct EventsDiff {
+	long *v;
+	size_t v_size;
+};
+
+void EventsDiff_Init(struct EventsDiff *diff);
+
+void EventsDiff_Done(struct EventsDiff *diff);
+
+uint64_t EventsDiff_Hash(const char *string);
+
+void EventsDiff_Align(struct EventsDiff *diff, const uint64_t *a,
+	size_t length_a, const uint64_t *b, size_t length_b,
+	struct EventsDiff_Result *result);
+
+#endif
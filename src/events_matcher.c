@@ -0,0 +1,846 @@
+#include <assert.h>
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include "events_matcher.h"
+
+#define EVENTSMATCHER_ERE_META ".[]\\()*+?{}|^$"
+#define EVENTSMATCHER_BRE_META ".[\\*^$"
+/* Escaped, these stand for themselves in both syntaxes */
+#define EVENTSMATCHER_ESCAPED_LITERALS "[].*^$\\"
+
+static bool EventsMatcher_IsQuantifier(const char *p, bool extended)
+{
+	if ('*' == p[0])
+		return true;
+	if (extended)
+		return '+' == p[0] || '?' == p[0] || '{' == p[0];
+	return '\\' == p[0] && 
+	       ('{' == p[1] || '+' == p[1] || '?' == p[1]);
+}
+
+/* Escapes like \< or \b look at the character before the match start */
+static bool EventsMatcher_HasContextEscape(const char *source)
+{
+	for (; *source; source++) {
+		if ('\\' != *source)
+			continue;
+		source++;
+		if (0 == *source)
+			break;
+		if (NULL == strchr(EVENTSMATCHER_ESCAPED_LITERALS "(){}|+?", *source))
+			return true;
+	}
+	return false;
+}
+
+/* Skips a bracket expression, p is at its '[' */
+static const char *EventsMatcher_SkipBracket(const char *p)
+{
+	p++;
+	if ('^' == *p)
+		p++;
+	if (']' == *p)
+		p++;
+	while (*p && ']' != *p)
+		p++;
+	return *p ? p : p - 1;
+}
+
+/* Alternation outside of any group makes the leading literal optional */
+static bool EventsMatcher_HasAlternation(const char *source, bool extended)
+{
+	int depth = 0;
+
+	for (; *source; source++) {
+		if ('[' == *source) {
+			source = EventsMatcher_SkipBracket(source);
+			continue;
+		}
+		if ('\\' == *source) {
+			source++;
+			if (0 == *source)
+				break;
+			if (extended)
+				continue;
+			if ('(' == *source)
+				depth++;
+			else if (')' == *source)
+				depth--;
+			else if ('|' == *source && 0 == depth)
+				return true;
+			continue;
+		}
+		if (!extended)
+			continue;
+		if ('(' == *source)
+			depth++;
+		else if (')' == *source)
+			depth--;
+		else if ('|' == *source && 0 == depth)
+			return true;
+	}
+	return false;
+}
+
+/* Conservative: stops at the first construct that is not a plain literal */
+static void EventsMatcher_Analyze(struct EventsMatcher_Pattern *pattern, 
+	const char *source, bool extended)
+{
+	const char *p = source;
+	size_t step;
+	char c;
+
+	pattern->literal = malloc(strlen(source) + 1);
+	assert(NULL != pattern->literal);
+	pattern->literal_length = 0;
+
+	if (EventsMatcher_HasAlternation(source, extended))
+		goto out;
+
+	if ('^' == *p) {
+		pattern->anchored = true;
+		p++;
+	}
+
+	while (*p) {
+		if ('\\' == *p) {
+			if (0 == p[1] || 
+			    NULL == strchr(EVENTSMATCHER_ESCAPED_LITERALS, p[1]))
+				break;
+			c = p[1];
+			step = 2;
+		} else if (NULL != strchr(extended ? 
+			   EVENTSMATCHER_ERE_META : EVENTSMATCHER_BRE_META, *p)) {
+			break;
+		} else {
+			c = *p;
+			step = 1;
+		}
+		if (EventsMatcher_IsQuantifier(p + step, extended))
+			break;
+		pattern->literal[pattern->literal_length++] = c;
+		p += step;
+	}
+
+	pattern->skip = !pattern->anchored && 
+		!EventsMatcher_HasContextEscape(source);
+out:
+	pattern->literal[pattern->literal_length] = 0;
+}
+
+/* First and last positions of a parsed part of the pattern */
+struct EventsMatcher_Sets {
+	uint64_t first;
+	uint64_t last;
+	bool nullable;
+};
+
+struct EventsMatcher_Parser {
+	const char *p;
+	bool extended;
+	bool multibyte;
+	struct EventsMatcher_Automaton *automaton;
+	size_t positions;
+	bool in_group;
+	bool failed;
+};
+
+static bool EventsMatcher_AtAlternation(struct EventsMatcher_Parser *parser)
+{
+	if (parser->extended)
+		return '|' == parser->p[0];
+	return '\\' == parser->p[0] && '|' == parser->p[1];
+}
+
+static bool EventsMatcher_AtGroup(struct EventsMatcher_Parser *parser, 
+	char c)
+{
+	if (parser->extended)
+		return c == parser->p[0];
+	return '\\' == parser->p[0] && c == parser->p[1];
+}
+
+static void EventsMatcher_Next(struct EventsMatcher_Parser *parser)
+{
+	parser->p += (parser->extended || '\\' != parser->p[0]) ? 1 : 2;
+}
+
+/* '$' ends the pattern */
+static bool EventsMatcher_AtConcatEnd(struct EventsMatcher_Parser *parser)
+{
+	return 0 == parser->p[0] || ('$' == parser->p[0] && 0 == parser->p[1]) ||
+	       EventsMatcher_AtAlternation(parser) || 
+	       EventsMatcher_AtGroup(parser, ')');
+}
+
+static bool EventsMatcher_Byte(struct EventsMatcher_Parser *parser, 
+	unsigned char c)
+{
+	if (c > 0x7f && parser->multibyte)
+		parser->failed = true;
+	return !parser->failed;
+}
+
+static const struct {
+	const char *name;
+	int (*is)(int c);
+} EventsMatcher_Classes[] = {
+	{"alnum", isalnum}, {"alpha", isalpha}, {"blank", isblank},
+	{"cntrl", iscntrl}, {"digit", isdigit}, {"graph", isgraph},
+	{"lower", islower}, {"print", isprint}, {"punct", ispunct},
+	{"space", isspace}, {"upper", isupper}, {"xdigit", isxdigit},
+};
+
+/* "[:name:]" at p, the bytes of the class go to set */
+static const char *EventsMatcher_ParseClass(struct EventsMatcher_Parser *parser,
+	const char *p, bool set[256])
+{
+	const char *end;
+	size_t i, c;
+
+	end = strstr(p + 2, ":]");
+	if (NULL == end) {
+		parser->failed = true;
+		return p;
+	}
+	for (i = 0; i < sizeof(EventsMatcher_Classes) / 
+	     sizeof(EventsMatcher_Classes[0]); i++)
+		if (strlen(EventsMatcher_Classes[i].name) == (size_t)(end - p - 2) &&
+		    0 == strncmp(EventsMatcher_Classes[i].name, p + 2, end - p - 2))
+			break;
+	if (i == sizeof(EventsMatcher_Classes) / sizeof(EventsMatcher_Classes[0])) {
+		parser->failed = true;
+		return p;
+	}
+	for (c = 1; c < (parser->multibyte ? 0x80 : 256); c++)
+		if (EventsMatcher_Classes[i].is(c))
+			set[c] = true;
+	return end + 2;
+}
+
+/* Bracket expression at '[', equivalence classes and collating symbols are
+ * not supported */
+static void EventsMatcher_ParseBracket(struct EventsMatcher_Parser *parser, 
+	bool set[256])
+{
+	const char *p = parser->p + 1;
+	bool negate = false, first = true;
+	unsigned char low, high;
+	size_t c;
+
+	if ('^' == *p) {
+		negate = true;
+		p++;
+	}
+	for (; !parser->failed; first = false) {
+		if (0 == *p) {
+			parser->failed = true;
+			break;
+		}
+		if (']' == *p && !first)
+			break;
+		if ('[' == p[0] && ':' == p[1]) {
+			p = EventsMatcher_ParseClass(parser, p, set);
+			continue;
+		}
+		if ('[' == p[0] && ('=' == p[1] || '.' == p[1])) {
+			parser->failed = true;
+			break;
+		}
+		low = high = *p++;
+		if ('-' == p[0] && 0 != p[1] && ']' != p[1]) {
+			high = p[1];
+			p += 2;
+			/* Ranges follow the collation beyond ASCII */
+			if ('[' == high || high > 0x7f || low > 0x7f || low > high)
+				parser->failed = true;
+		}
+		if (!EventsMatcher_Byte(parser, low))
+			break;
+		for (c = low; c <= high; c++)
+			set[c] = true;
+	}
+	parser->p = p + 1;
+
+	if (negate)
+		for (c = 1; c < 256; c++)
+			set[c] = !set[c];
+	set[0] = false;
+}
+
+/* One position: a character, '.' or a bracket expression */
+static struct EventsMatcher_Sets EventsMatcher_ParseAtom(
+	struct EventsMatcher_Parser *parser)
+{
+	static const char *ere_escapes = ".[]\\()*+?{}|^$";
+	static const char *bre_escapes = ".[]\\*^$";
+	struct EventsMatcher_Automaton *automaton = parser->automaton;
+	struct EventsMatcher_Sets sets = {0, 0, false};
+	bool set[256];
+	const char *p = parser->p;
+	uint64_t bit;
+	size_t c;
+
+	if (parser->positions == EVENTSMATCHER_POSITIONS) {
+		parser->failed = true;
+		return sets;
+	}
+	memset(set, 0, sizeof(set));
+
+	if ('.' == *p) {
+		memset(set + 1, true, 255);
+		parser->p++;
+	} else if ('[' == *p) {
+		EventsMatcher_ParseBracket(parser, set);
+	} else if ('\\' == *p) {
+		if (0 == p[1] || NULL == strchr(parser->extended ? 
+		    ere_escapes : bre_escapes, p[1]))
+			parser->failed = true;
+		else if (EventsMatcher_Byte(parser, p[1]))
+			set[(unsigned char)p[1]] = true;
+		parser->p += 2;
+	} else if (NULL != strchr(parser->extended ? "()*+?{|^$" : "*^$", *p)) {
+		/* Leading quantifiers, intervals and inner anchors */
+		parser->failed = true;
+	} else if (EventsMatcher_Byte(parser, *p)) {
+		set[(unsigned char)*p] = true;
+		parser->p++;
+	}
+	if (parser->failed)
+		return sets;
+
+	bit = (uint64_t)1 << parser->positions++;
+	for (c = 0; c < 256; c++)
+		if (set[c])
+			automaton->accepts[c] |= bit;
+	if (parser->in_group)
+		automaton->group |= bit;
+	sets.first = sets.last = bit;
+	return sets;
+}
+
+static void EventsMatcher_AddFollow(struct EventsMatcher_Automaton *automaton,
+	uint64_t from, uint64_t to)
+{
+	size_t i;
+
+	for (i = 0; i < EVENTSMATCHER_POSITIONS; i++)
+		if (from & ((uint64_t)1 << i))
+			automaton->follow[i] |= to;
+}
+
+/* Quantifiers apply to a single position */
+static struct EventsMatcher_Sets EventsMatcher_ParseQuantified(
+	struct EventsMatcher_Parser *parser)
+{
+	struct EventsMatcher_Sets sets;
+	const char *p;
+
+	sets = EventsMatcher_ParseAtom(parser);
+	while (!parser->failed) {
+		p = parser->p;
+		/* "\\+" and "\\?" in basic syntax, where "\\*" is a character */
+		if (!parser->extended && '\\' == p[0]) {
+			p++;
+			if ('*' == *p)
+				break;
+		} else if (!parser->extended && '*' != p[0])
+			break;
+		if ('{' == *p) {
+			parser->failed = true;
+			break;
+		}
+		if ('*' != *p && '+' != *p && '?' != *p)
+			break;
+		if ('?' != *p)
+			EventsMatcher_AddFollow(parser->automaton, 
+				sets.last, sets.first);
+		if ('+' != *p)
+			sets.nullable = true;
+		parser->p = p + 1;
+	}
+	return sets;
+}
+
+static struct EventsMatcher_Sets EventsMatcher_ParseAlternation(
+	struct EventsMatcher_Parser *parser, size_t *branches);
+
+/* Alternatives of the group between begin and end are strings and none is
+ * a prefix of another, so that at most one of them matches at an offset:
+ * regexec does not take the longest alternative for the group otherwise */
+static bool EventsMatcher_PlainBranches(const char *begin, const char *end,
+	bool extended)
+{
+	char strings[EVENTSMATCHER_POSITIONS][EVENTSMATCHER_POSITIONS + 1];
+	size_t lengths[EVENTSMATCHER_POSITIONS];
+	size_t branches = 0, i, j;
+	const char *p;
+
+	lengths[0] = 0;
+	for (p = begin; p < end; p++) {
+		if (extended ? '|' == *p : '\\' == p[0] && '|' == p[1]) {
+			p += extended ? 0 : 1;
+			lengths[++branches] = 0;
+			continue;
+		}
+		if ('\\' == *p) {
+			p++;
+			if (NULL == strchr(extended ? ".[]\\()*+?{}|^$" : ".[]\\*^$", *p))
+				return false;
+		} else if (NULL != strchr(extended ? ".[*+?" : ".[*", *p))
+			return false;
+		strings[branches][lengths[branches]++] = *p;
+	}
+	branches++;
+
+	for (i = 0; i < branches; i++)
+		for (j = 0; j < branches; j++)
+			if (i != j && lengths[i] <= lengths[j] &&
+			    0 == memcmp(strings[i], strings[j], lengths[i]))
+				return false;
+	return true;
+}
+
+static struct EventsMatcher_Sets EventsMatcher_ParseGroup(
+	struct EventsMatcher_Parser *parser)
+{
+	struct EventsMatcher_Sets sets = {0, 0, false};
+	const char *begin;
+	size_t branches;
+
+	if (parser->in_group || parser->automaton->has_group) {
+		parser->failed = true;
+		return sets;
+	}
+	EventsMatcher_Next(parser);
+	begin = parser->p;
+	parser->in_group = true;
+	sets = EventsMatcher_ParseAlternation(parser, &branches);
+	parser->in_group = false;
+	parser->automaton->has_group = true;
+
+	/* The group must span at least one character, and only once */
+	if (!EventsMatcher_AtGroup(parser, ')') || sets.nullable ||
+	    (branches > 1 && !EventsMatcher_PlainBranches(begin, parser->p, 
+	     parser->extended)))
+		parser->failed = true;
+	else
+		EventsMatcher_Next(parser);
+	if ('*' == parser->p[0] || (parser->extended ? 
+	    NULL != strchr("+?{", parser->p[0]) :
+	    '\\' == parser->p[0] && NULL != strchr("+?{", parser->p[1])))
+		parser->failed = true;
+	return sets;
+}
+
+static struct EventsMatcher_Sets EventsMatcher_ParseConcat(
+	struct EventsMatcher_Parser *parser)
+{
+	struct EventsMatcher_Sets sets = {0, 0, true}, piece;
+
+	while (!parser->failed && !EventsMatcher_AtConcatEnd(parser)) {
+		if (EventsMatcher_AtGroup(parser, '('))
+			piece = EventsMatcher_ParseGroup(parser);
+		else
+			piece = EventsMatcher_ParseQuantified(parser);
+		if (parser->failed)
+			break;
+		EventsMatcher_AddFollow(parser->automaton, sets.last, piece.first);
+		if (sets.nullable)
+			sets.first |= piece.first;
+		sets.last = piece.nullable ? sets.last | piece.last : piece.last;
+		sets.nullable = sets.nullable && piece.nullable;
+	}
+	return sets;
+}
+
+static struct EventsMatcher_Sets EventsMatcher_ParseAlternation(
+	struct EventsMatcher_Parser *parser, size_t *branches)
+{
+	struct EventsMatcher_Sets sets, branch;
+
+	sets = EventsMatcher_ParseConcat(parser);
+	for (*branches = 1; !parser->failed && 
+	     EventsMatcher_AtAlternation(parser); (*branches)++) {
+		EventsMatcher_Next(parser);
+		branch = EventsMatcher_ParseConcat(parser);
+		sets.first |= branch.first;
+		sets.last |= branch.last;
+		sets.nullable = sets.nullable || branch.nullable;
+	}
+	return sets;
+}
+
+/* NULL when the pattern is outside the subset */
+static struct EventsMatcher_Automaton *EventsMatcher_Build(const char *source,
+	int cflags)
+{
+	struct EventsMatcher_Parser parser;
+	struct EventsMatcher_Sets sets;
+	size_t branches;
+
+	if (0 != (cflags & ~REG_EXTENDED))
+		return NULL;
+
+	memset(&parser, 0, sizeof(parser));
+	parser.p = source;
+	parser.extended = 0 != (cflags & REG_EXTENDED);
+	parser.multibyte = MB_CUR_MAX > 1;
+	parser.automaton = calloc(1, sizeof(*parser.automaton));
+	assert(NULL != parser.automaton);
+
+	if ('^' == *parser.p) {
+		parser.automaton->anchored = true;
+		parser.p++;
+	}
+	sets = EventsMatcher_ParseAlternation(&parser, &branches);
+	if ('$' == parser.p[0] && 0 == parser.p[1]) {
+		parser.automaton->end_anchored = true;
+		parser.p++;
+	}
+	/* Anchors and the group belong to a single branch */
+	if (0 != *parser.p || (branches > 1 && (parser.automaton->anchored || 
+	    parser.automaton->end_anchored || parser.automaton->has_group)))
+		parser.failed = true;
+
+	if (parser.failed) {
+		free(parser.automaton);
+		return NULL;
+	}
+	parser.automaton->first = sets.first;
+	parser.automaton->last = sets.last;
+	parser.automaton->nullable = sets.nullable;
+	return parser.automaton;
+}
+
+int EventsMatcher_Compile(struct EventsMatcher_Pattern *pattern, 
+	const char *source, int cflags)
+{
+	memset(pattern, 0, sizeof(*pattern));
+	if (regcomp(&pattern->regex, source, cflags))
+		return -1;
+	pattern->compiled = true;
+
+	pattern->source = strdup(source);
+	assert(NULL != pattern->source);
+	EventsMatcher_Analyze(pattern, source, 0 != (cflags & REG_EXTENDED));
+	/* regcomp takes the locale of this moment too */
+	pattern->automaton = EventsMatcher_Build(source, cflags);
+	pattern->multibyte = MB_CUR_MAX > 1;
+	return 0;
+}
+
+void EventsMatcher_Free(struct EventsMatcher_Pattern *pattern)
+{
+	if (!pattern->compiled)
+		return;
+	regfree(&pattern->regex);
+	free(pattern->source);
+	free(pattern->literal);
+	free(pattern->automaton);
+	memset(pattern, 0, sizeof(*pattern));
+}
+
+bool EventsMatcher_Exec(struct EventsMatcher_Pattern *pattern, 
+	const char *buffer, size_t n_match, regmatch_t matches[])
+{
+	const char *start;
+	size_t i;
+	regoff_t offset;
+
+	if (0 == pattern->literal_length)
+		return 0 == regexec(&pattern->regex, buffer, n_match, matches, 0);
+
+	if (pattern->anchored) {
+		if (0 != strncmp(buffer, pattern->literal, pattern->literal_length))
+			return false;
+		return 0 == regexec(&pattern->regex, buffer, n_match, matches, 0);
+	}
+
+	start = strstr(buffer, pattern->literal);
+	if (NULL == start)
+		return false;
+	if (!pattern->skip || start == buffer)
+		return 0 == regexec(&pattern->regex, buffer, n_match, matches, 0);
+
+	/* The leftmost match can't start before the first literal */
+	if (regexec(&pattern->regex, start, n_match, matches, REG_NOTBOL))
+		return false;
+	offset = start - buffer;
+	for (i = 0; i < n_match; i++)
+		if (-1 != matches[i].rm_so) {
+			matches[i].rm_so += offset;
+			matches[i].rm_eo += offset;
+		}
+	return true;
+}
+
+/* Threads of one pattern, a position keeps the leftmost start reaching it
+ * and then the latest group start and end, which is the POSIX choice for
+ * a single group: the part before it and then the group match the most */
+struct EventsMatcher_Run {
+	const struct EventsMatcher_Automaton *automaton;
+	uint64_t active;
+	regoff_t start[EVENTSMATCHER_POSITIONS];
+	regoff_t group_start[EVENTSMATCHER_POSITIONS];
+	regoff_t group_end[EVENTSMATCHER_POSITIONS];
+	regmatch_t best[2];
+	bool done;
+};
+
+static bool EventsMatcher_Prefer(regoff_t start, regoff_t group_start,
+	regoff_t group_end, regoff_t other_start, regoff_t other_group_start,
+	regoff_t other_group_end)
+{
+	if (start != other_start)
+		return start < other_start;
+	if (group_start != other_group_start)
+		return group_start > other_group_start;
+	return group_end > other_group_end;
+}
+
+static void EventsMatcher_RunInit(struct EventsMatcher_Run *run,
+	const struct EventsMatcher_Automaton *automaton)
+{
+	run->automaton = automaton;
+	run->active = 0;
+	run->best[0].rm_so = run->best[0].rm_eo = -1;
+	run->best[1].rm_so = run->best[1].rm_eo = -1;
+	run->done = NULL == automaton;
+}
+
+static void EventsMatcher_RunMatch(struct EventsMatcher_Run *run, 
+	regoff_t start, regoff_t end, regoff_t group_start, regoff_t group_end)
+{
+	regmatch_t *best = run->best;
+
+	if (-1 != best[0].rm_so && (start > best[0].rm_so || 
+	    (start == best[0].rm_so && (end < best[0].rm_eo || 
+	     (end == best[0].rm_eo && !EventsMatcher_Prefer(start, group_start,
+	      group_end, best[0].rm_so, best[1].rm_so, best[1].rm_eo))))))
+		return;
+	best[0].rm_so = start;
+	best[0].rm_eo = end;
+	best[1].rm_so = group_start;
+	best[1].rm_eo = group_end;
+}
+
+static void EventsMatcher_RunAdd(uint64_t *next, int q, regoff_t start[], regoff_t group_start[], 
+	regoff_t group_end[], regoff_t s, regoff_t g, regoff_t e)
+{
+	if ((*next & ((uint64_t)1 << q)) && !EventsMatcher_Prefer(s, g, e, 
+	    start[q], group_start[q], group_end[q]))
+		return;
+	*next |= (uint64_t)1 << q;
+	start[q] = s;
+	group_start[q] = g;
+	group_end[q] = e;
+}
+
+/* Takes the byte at offset i, the empty match at i comes first */
+static void EventsMatcher_RunStep(struct EventsMatcher_Run *run, 
+	const unsigned char *buffer, regoff_t i)
+{
+	const struct EventsMatcher_Automaton *automaton = run->automaton;
+	regoff_t start[EVENTSMATCHER_POSITIONS];
+	regoff_t group_start[EVENTSMATCHER_POSITIONS];
+	regoff_t group_end[EVENTSMATCHER_POSITIONS];
+	uint64_t next = 0, bits, targets;
+	bool found = -1 != run->best[0].rm_so;
+	bool starts = !found && (!automaton->anchored || 0 == i);
+	regoff_t g, e;
+	int p, q;
+
+	if (starts && automaton->nullable && 
+	    (!automaton->end_anchored || 0 == buffer[i])) {
+		EventsMatcher_RunMatch(run, i, i, -1, -1);
+		found = true;
+	}
+	if (0 == buffer[i]) {
+		run->done = true;
+		return;
+	}
+
+	for (bits = run->active; bits; bits &= bits - 1) {
+		p = __builtin_ctzll(bits);
+		targets = automaton->follow[p] & automaton->accepts[buffer[i]];
+		for (; targets; targets &= targets - 1) {
+			q = __builtin_ctzll(targets);
+			g = run->group_start[p];
+			e = run->group_end[p];
+			if ((automaton->group >> q & 1) && !(automaton->group >> p & 1))
+				g = i;
+			if (!(automaton->group >> q & 1) && (automaton->group >> p & 1))
+				e = i;
+			EventsMatcher_RunAdd(&next, q, start, group_start, 
+				group_end, run->start[p], g, e);
+		}
+	}
+	if (starts) {
+		targets = automaton->first & automaton->accepts[buffer[i]];
+		for (; targets; targets &= targets - 1) {
+			q = __builtin_ctzll(targets);
+			EventsMatcher_RunAdd(&next, q, start, group_start, 
+				group_end, i, (automaton->group >> q & 1) ? i : -1, -1);
+		}
+	}
+
+	run->active = next;
+	for (bits = next; bits; bits &= bits - 1) {
+		q = __builtin_ctzll(bits);
+		run->start[q] = start[q];
+		run->group_start[q] = group_start[q];
+		run->group_end[q] = group_end[q];
+	}
+
+	if (!automaton->end_anchored || 0 == buffer[i + 1])
+		for (bits = next & automaton->last; bits; bits &= bits - 1) {
+			q = __builtin_ctzll(bits);
+			EventsMatcher_RunMatch(run, start[q], i + 1, group_start[q],
+				(automaton->group >> q & 1) ? i + 1 : group_end[q]);
+		}
+
+	/* Threads starting after the best match can't replace it */
+	if (-1 != run->best[0].rm_so)
+		for (bits = run->active; bits; bits &= bits - 1) {
+			q = __builtin_ctzll(bits);
+			if (run->start[q] > run->best[0].rm_so)
+				run->active &= ~((uint64_t)1 << q);
+		}
+	if (0 == run->active && (-1 != run->best[0].rm_so || 
+	    automaton->anchored))
+		run->done = true;
+}
+
+/* Runs the automata of the patterns side by side in one pass over the 
+ * line, matches are those regexec gives with two slots. Stops as soon as
+ * the first pattern can't match: the line is rejected. NULL patterns and
+ * patterns without automaton match nothing */
+bool EventsMatcher_ExecSet(struct EventsMatcher_Pattern *patterns[], 
+	size_t patterns_length, const char *buffer, regmatch_t matches[][2])
+{
+	struct EventsMatcher_Run runs[EVENTSMATCHER_SET_SIZE];
+	size_t k;
+	regoff_t i;
+	bool pending = true;
+
+	assert(patterns_length > 0 && patterns_length <= EVENTSMATCHER_SET_SIZE);
+	for (k = 0; k < patterns_length; k++)
+		EventsMatcher_RunInit(&runs[k], NULL != patterns[k] ? 
+			patterns[k]->automaton : NULL);
+
+	for (i = 0; pending; i++) {
+		pending = false;
+		for (k = 0; k < patterns_length; k++) {
+			if (runs[k].done)
+				continue;
+			EventsMatcher_RunStep(&runs[k], 
+				(const unsigned char *)buffer, i);
+			pending = pending || !runs[k].done;
+		}
+		if (runs[0].done && -1 == runs[0].best[0].rm_so)
+			return false;
+	}
+
+	for (k = 0; k < patterns_length; k++) {
+		matches[k][0] = runs[k].best[0];
+		matches[k][1] = runs[k].best[1];
+	}
+	return true;
+}
+
+/* Multibyte locales give other spans only to lines with such bytes */
+bool EventsMatcher_Ascii(const char *buffer)
+{
+	for (; *buffer; buffer++)
+		if (*buffer & 0x80)
+			return false;
+	return true;
+}
+
+static void EventsMatcher_Span(regmatch_t *match, const char *buffer,
+	const char *begin, const char *end)
+{
+	match->rm_so = begin - buffer;
+	match->rm_eo = end - buffer;
+}
+
+/* EVENTSDB_PATTERN_LINE_VALID without regexec */
+bool EventsMatcher_UvmValid(const char *buffer, struct EventsMatcher_Spans *uvm)
+{
+	static const char *severities[] = {"INFO", "WARNING", "ERROR", "FATAL"};
+	const char *name;
+	size_t i, length;
+
+	if (0 != strncmp(buffer, "UVM_", 4))
+		return false;
+	name = buffer + 4;
+
+	for (i = 0; i < sizeof(severities) / sizeof(severities[0]); i++) {
+		length = strlen(severities[i]);
+		if (0 == strncmp(name, severities[i], length) && 
+		    ' ' == name[length])
+			break;
+	}
+	if (i == sizeof(severities) / sizeof(severities[0]))
+		return false;
+	if (NULL == strchr(name + length + 1, '@'))
+		return false;
+
+	EventsMatcher_Span(&uvm->severity, buffer, name, name + length);
+	return true;
+}
+
+/* ": ([^ []+) \[", leftmost */
+static void EventsMatcher_UvmPath(const char *buffer, 
+	struct EventsMatcher_Spans *uvm)
+{
+	const char *colon, *begin, *end;
+
+	uvm->path.rm_so = -1;
+	uvm->path.rm_eo = -1;
+	for (colon = strchr(buffer, ':'); colon != NULL; 
+	     colon = strchr(colon + 1, ':')) {
+		if (' ' != colon[1])
+			continue;
+		begin = colon + 2;
+		end = begin + strcspn(begin, " [");
+		if (end == begin || ' ' != end[0] || '[' != end[1])
+			continue;
+		EventsMatcher_Span(&uvm->path, buffer, begin, end);
+		return;
+	}
+}
+
+/* EVENTSDB_PATTERN_EXTRACT_* without regexec, the line is valid */
+enum EventsMatcher_UvmResult EventsMatcher_UvmExtract(const char *buffer, 
+	struct EventsMatcher_Spans *uvm)
+{
+	const char *open, *close, *at, *digits;
+
+	/* "\[.*\]": first '[' to the last ']' */
+	open = strchr(buffer, '[');
+	close = strrchr(buffer, ']');
+	if (NULL == open || NULL == close || close < open)
+		return EVENTSMATCHER_UVM_MALFORMED;
+	EventsMatcher_Span(&uvm->marker, buffer, open, close + 1);
+
+	/* "@ [0-9]*" */
+	for (at = strchr(buffer, '@'); at != NULL && ' ' != at[1]; 
+	     at = strchr(at + 1, '@'))
+		;
+	if (NULL == at)
+		return EVENTSMATCHER_UVM_MALFORMED;
+	digits = at + 2;
+	while (*digits >= '0' && *digits <= '9')
+		digits++;
+	EventsMatcher_Span(&uvm->time, buffer, at, digits);
+
+	/* "\].*$": first ']' to the end */
+	close = strchr(buffer, ']');
+	EventsMatcher_Span(&uvm->message, buffer, close, close + strlen(close));
+
+	EventsMatcher_UvmPath(buffer, uvm);
+	return EVENTSMATCHER_UVM_OK;
+}
@@ -0,0 +1,79 @@
+#ifndef __EVENTS_MATCHER__
+#define __EVENTS_MATCHER__
+
+#include <regex.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Positions of an automaton, one per character matcher of the pattern */
+#define EVENTSMATCHER_POSITIONS 64
+/* Patterns run by EventsMatcher_ExecSet at once */
+#define EVENTSMATCHER_SET_SIZE 8
+
+/* Position automaton of a pattern of the supported subset: characters, 
+ * '.', bracket expressions, '*', '+', '?', alternation, '^' and '$' at the
+ * ends and one capture group that is not repeated. Bits are positions */
+struct EventsMatcher_Automaton {
+	uint64_t accepts[256];	/* positions that take the byte */
+	uint64_t follow[EVENTSMATCHER_POSITIONS];
+	uint64_t first;
+	uint64_t last;
+	uint64_t group;		/* positions inside the capture group */
+	bool nullable;
+	bool anchored;
+	bool end_anchored;
+	bool has_group;
+};
+
+/* regex_t plus what a literal scan of the source tells about every match */
+struct EventsMatcher_Pattern {
+	regex_t regex;
+	bool compiled;
+	char *source;
+
+	char *literal;		/* every match starts with it */
+	size_t literal_length;
+	bool anchored;		/* literal is at the line start */
+	bool skip;		/* regexec may start at the first literal */
+
+	/* NULL when the pattern is outside the subset */
+	struct EventsMatcher_Automaton *automaton;
+	/* Compiled in a multibyte locale, where regexec takes bytes above 
+	 * 0x7f as characters and the automaton can't stand for it */
+	bool multibyte;
+};
+
+/* Spans of the line fields, same offsets the regexes give */
+struct EventsMatcher_Spans {
+	regmatch_t severity;
+	regmatch_t marker;
+	regmatch_t time;
+	regmatch_t message;
+	regmatch_t path;
+};
+
+enum EventsMatcher_UvmResult {
+	EVENTSMATCHER_UVM_OK,
+	EVENTSMATCHER_UVM_MALFORMED
+};
+
+int EventsMatcher_Compile(struct EventsMatcher_Pattern *pattern, 
+	const char *source, int cflags);
+
+void EventsMatcher_Free(struct EventsMatcher_Pattern *pattern);
+
+bool EventsMatcher_Exec(struct EventsMatcher_Pattern *pattern, 
+	const char *buffer, size_t n_match, regmatch_t matches[]);
+
+bool EventsMatcher_ExecSet(struct EventsMatcher_Pattern *patterns[], 
+	size_t patterns_length, const char *buffer, regmatch_t matches[][2]);
+
+bool EventsMatcher_Ascii(const char *buffer);
+
+bool EventsMatcher_UvmValid(const char *buffer, struct EventsMatcher_Spans *uvm);
+
+enum EventsMatcher_UvmResult EventsMatcher_UvmExtract(const char *buffer, 
+	struct EventsMatcher_Spans *uvm);
+
+#endif
@@ -0,0 +1,246 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "events_paths.h"
+
+#define EVENTSPATHS_SLOTS_INITIAL_SIZE 256
+#define EVENTSPATHS_IDS_INITIAL_SIZE 64
+
+void EventsPaths_Init(struct EventsPaths *paths)
+{
+	memset(paths, 0, sizeof(*paths));
+	paths->root.name = EVENTSPATHS_ROOT_NAME;
+	paths->root.enabled = true;
+	paths->nodes = 1;
+}
+
+static void EventsPaths_FreeNode(struct EventsPaths_Node *node)
+{
+	struct EventsPaths_Node *child, *next;
+
+	for (child = node->children; child != NULL; child = next) {
+		next = child->next;
+		EventsPaths_FreeNode(child);
+		free((char *)child->name);
+		free(child);
+	}
+}
+
+void EventsPaths_Done(struct EventsPaths *paths)
+{
+	size_t i;
+
+	for (i = 0; i < paths->slots_size; i++)
+		free((char *)paths->slots[i].path);
+	free(paths->slots);
+	free(paths->by_order);
+	free(paths->by_id);
+	EventsPaths_FreeNode(&paths->root);
+	EventsPaths_Init(paths);
+}
+
+static uint32_t EventsPaths_Hash(const char *path)
+{
+	uint32_t hash = 2166136261u;
+
+	while (*path) {
+		hash ^= (unsigned char)*path++;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+static struct EventsPaths_Slot *EventsPaths_Lookup(struct EventsPaths_Slot *slots,
+	size_t slots_size, const char *path)
+{
+	size_t i;
+
+	i = EventsPaths_Hash(path) & (slots_size - 1);
+	while (NULL != slots[i].path && 0 != strcmp(slots[i].path, path))
+		i = (i + 1) & (slots_size - 1);
+	return &slots[i];
+}
+
+static void EventsPaths_Grow(struct EventsPaths *paths)
+{
+	struct EventsPaths_Slot *slots, *slot;
+	size_t slots_size, i;
+
+	slots_size = paths->slots_size ? 
+		paths->slots_size * 2 : EVENTSPATHS_SLOTS_INITIAL_SIZE;
+	slots = calloc(slots_size, sizeof(*slots));
+	assert(NULL != slots);
+
+	for (i = 0; i < paths->slots_size; i++) {
+		if (NULL == paths->slots[i].path)
+			continue;
+		slot = EventsPaths_Lookup(slots, slots_size, paths->slots[i].path);
+		*slot = paths->slots[i];
+	}
+	free(paths->slots);
+	paths->slots = slots;
+	paths->slots_size = slots_size;
+}
+
+static struct EventsPaths_Node *EventsPaths_Child(struct EventsPaths *paths,
+	struct EventsPaths_Node *parent, const char *name, size_t length)
+{
+	struct EventsPaths_Node *node;
+	char *node_name;
+
+	for (node = parent->children; node != NULL; node = node->next)
+		if (0 == strncmp(node->name, name, length) && 
+		    0 == node->name[length])
+			return node;
+
+	node_name = malloc(length + 1);
+	assert(NULL != node_name);
+	memcpy(node_name, name, length);
+	node_name[length] = 0;
+
+	node = calloc(1, sizeof(*node));
+	assert(NULL != node);
+	node->name = node_name;
+	node->parent = parent;
+	node->enabled = parent->enabled;
+	if (!node->enabled)
+		paths->disabled++;
+
+	if (NULL == parent->last_child)
+		parent->children = node;
+	else
+		parent->last_child->next = node;
+	parent->last_child = node;
+
+	if (paths->nodes >= paths->by_id_capacity) {
+		paths->by_id_capacity = paths->by_id_capacity ?
+			paths->by_id_capacity * 2 : EVENTSPATHS_IDS_INITIAL_SIZE;
+		paths->by_id = realloc(paths->by_id, 
+			paths->by_id_capacity * sizeof(*paths->by_id));
+		assert(NULL != paths->by_id);
+	}
+	node->id = paths->nodes;
+	paths->by_id[node->id] = node;
+
+	paths->nodes++;
+	paths->indexed = false;
+	return node;
+}
+
+struct EventsPaths_Node *EventsPaths_Insert(struct EventsPaths *paths, 
+	const char *path)
+{
+	struct EventsPaths_Slot *slot;
+	struct EventsPaths_Node *node;
+	const char *name, *separator;
+	char *path_copy;
+
+	if (NULL == path || 0 == path[0]) {
+		paths->root.events++;
+		return &paths->root;
+	}
+
+	if (2 * (paths->slots_used + 1) > paths->slots_size)
+		EventsPaths_Grow(paths);
+
+	slot = EventsPaths_Lookup(paths->slots, paths->slots_size, path);
+	if (NULL != slot->path) {
+		slot->node->events++;
+		return slot->node;
+	}
+
+	node = &paths->root;
+	for (name = path; ; name = separator + 1) {
+		separator = strchr(name, EVENTSPATHS_SEPARATOR);
+		if (NULL == separator)
+			separator = name + strlen(name);
+		node = EventsPaths_Child(paths, node, name, separator - name);
+		if (0 == *separator)
+			break;
+	}
+
+	path_copy = strdup(path);
+	assert(NULL != path_copy);
+	slot->path = path_copy;
+	slot->node = node;
+	paths->slots_used++;
+
+	node->events++;
+	return node;
+}
+
+static size_t EventsPaths_ReindexNode(struct EventsPaths *paths, 
+	struct EventsPaths_Node *node, size_t order)
+{
+	struct EventsPaths_Node *child;
+	size_t next_order;
+
+	node->order = order;
+	paths->by_order[order] = node;
+	node->subtree_events = node->events;
+
+	next_order = order + 1;
+	for (child = node->children; child != NULL; child = child->next) {
+		next_order = EventsPaths_ReindexNode(paths, child, next_order);
+		node->subtree_events += child->subtree_events;
+	}
+	node->subtree_size = next_order - order;
+	return next_order;
+}
+
+void EventsPaths_Reindex(struct EventsPaths *paths)
+{
+	size_t size;
+
+	size = paths->nodes * sizeof(*paths->by_order);
+	paths->by_order = realloc(paths->by_order, size);
+	assert(NULL != paths->by_order);
+
+	EventsPaths_ReindexNode(paths, &paths->root, 0);
+	paths->indexed = true;
+}
+
+struct EventsPaths_Node *EventsPaths_GetRoot(struct EventsPaths *paths)
+{
+	if (!paths->indexed)
+		EventsPaths_Reindex(paths);
+	return &paths->root;
+}
+
+/* Id 0 is the root, ids of the other nodes follow their creation */
+struct EventsPaths_Node *EventsPaths_GetNode(struct EventsPaths *paths, 
+	size_t id)
+{
+	assert(id < paths->nodes);
+	if (0 == id)
+		return &paths->root;
+	return paths->by_id[id];
+}
+
+void EventsPaths_SetEnabled(struct EventsPaths *paths, 
+	struct EventsPaths_Node *node, bool enabled)
+{
+	size_t i, end;
+	struct EventsPaths_Node *np;
+
+	if (!paths->indexed)
+		EventsPaths_Reindex(paths);
+
+	end = node->order + node->subtree_size;
+	for (i = node->order; i < end; i++) {
+		np = paths->by_order[i];
+		if (np->enabled == enabled)
+			continue;
+		np->enabled = enabled;
+		if (enabled)
+			paths->disabled--;
+		else
+			paths->disabled++;
+	}
+}
+
+bool EventsPaths_AllEnabled(struct EventsPaths *paths)
+{
+	return 0 == paths->disabled;
+}
@@ -0,0 +1,71 @@
+#ifndef __EVENTS_PATHS__
+#define __EVENTS_PATHS__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define EVENTSPATHS_SEPARATOR '.'
+#define EVENTSPATHS_ROOT_NAME "Hierarchy"
+
+/* One level of a component path, e.g. "dll2phy_env_inst" */
+struct EventsPaths_Node {
+	const char *name;
+	struct EventsPaths_Node *parent;
+	struct EventsPaths_Node *children;
+	struct EventsPaths_Node *last_child;
+	struct EventsPaths_Node *next;
+
+	/* Creation order, stable across reindexing */
+	size_t id;
+
+	/* Valid after EventsPaths_Reindex: the subtree occupies positions
+	 * [order, order + subtree_size) of the pre-order */
+	size_t order;
+	size_t subtree_size;
+
+	size_t events;
+	size_t subtree_events;
+	bool enabled;
+};
+
+struct EventsPaths_Slot {
+	const char *path;
+	struct EventsPaths_Node *node;
+};
+
+struct EventsPaths {
+	struct EventsPaths_Node root;
+	size_t nodes;
+
+	/* Full path to leaf node lookup, open addressing */
+	struct EventsPaths_Slot *slots;
+	size_t slots_used;
+	size_t slots_size;
+
+	struct EventsPaths_Node **by_order;
+	struct EventsPaths_Node **by_id;
+	size_t by_id_capacity;
+	bool indexed;
+	size_t disabled;
+};
+
+void EventsPaths_Init(struct EventsPaths *paths);
+
+void EventsPaths_Done(struct EventsPaths *paths);
+
+struct EventsPaths_Node *EventsPaths_Insert(struct EventsPaths *paths, 
+	const char *path);
+
+void EventsPaths_Reindex(struct EventsPaths *paths);
+
+struct EventsPaths_Node *EventsPaths_GetRoot(struct EventsPaths *paths);
+
+struct EventsPaths_Node *EventsPaths_GetNode(struct EventsPaths *paths, 
+	size_t id);
+
+void EventsPaths_SetEnabled(struct EventsPaths *paths, 
+	struct EventsPaths_Node *node, bool enabled);
+
+bool EventsPaths_AllEnabled(struct EventsPaths *paths);
+
+#endif
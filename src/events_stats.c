@@ -0,0 +1,165 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "events_stats.h"
+
+#define EVENTSSTATS_SPANS_INITIAL_SIZE 64
+
+static const char *EventsStats_StageNames[EVENTSSTATS_TOTAL] = {
+	[EVENTSSTATS_LOAD]     = "load",
+	[EVENTSSTATS_READ]     = "read",
+	[EVENTSSTATS_VALIDATE] = "validate",
+	[EVENTSSTATS_EXTRACT]  = "extract",
+	[EVENTSSTATS_INDEX]    = "index",
+	[EVENTSSTATS_TABLE]    = "table",
+	[EVENTSSTATS_STORE]    = "store",
+};
+
+/* Stages timed once per line, too many calls to trace one by one */
+static bool EventsStats_PerLine(enum EventsStats_Stage stage)
+{
+	return EVENTSSTATS_READ == stage ||
+	       EVENTSSTATS_VALIDATE == stage ||
+	       EVENTSSTATS_EXTRACT == stage ||
+	       EVENTSSTATS_INDEX == stage;
+}
+
+static unsigned long long EventsStats_Now(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (unsigned long long)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+void EventsStats_Init(struct EventsStats *stats)
+{
+	memset(stats, 0, sizeof(*stats));
+}
+
+void EventsStats_Done(struct EventsStats *stats)
+{
+	free(stats->spans);
+	EventsStats_Init(stats);
+}
+
+void EventsStats_Enable(struct EventsStats *stats, bool trace)
+{
+	stats->enabled = true;
+	stats->trace_enabled = trace;
+	stats->origin = EventsStats_Now();
+}
+
+const char *EventsStats_StageName(enum EventsStats_Stage stage)
+{
+	assert(stage < EVENTSSTATS_TOTAL);
+	return EventsStats_StageNames[stage];
+}
+
+unsigned long long EventsStats_Begin(struct EventsStats *stats)
+{
+	if (!stats->enabled)
+		return 0;
+	return EventsStats_Now();
+}
+
+static void EventsStats_AddSpan(struct EventsStats *stats, 
+	enum EventsStats_Stage stage, unsigned long long begin,
+	unsigned long long duration)
+{
+	struct EventsStats_Span *span;
+	size_t size;
+
+	if (stats->spans_length == stats->spans_capacity) {
+		stats->spans_capacity = stats->spans_capacity ? 
+			stats->spans_capacity * 2 : EVENTSSTATS_SPANS_INITIAL_SIZE;
+		size = stats->spans_capacity * sizeof(*stats->spans);
+		stats->spans = realloc(stats->spans, size);
+		assert(NULL != stats->spans);
+	}
+
+	span = &stats->spans[stats->spans_length++];
+	span->stage = stage;
+	span->begin = begin - stats->origin;
+	span->duration = duration;
+	memset(span->stages, 0, sizeof(span->stages));
+	if (EVENTSSTATS_LOAD != stage)
+		return;
+	memcpy(span->stages, stats->span_stages, sizeof(span->stages));
+	memset(stats->span_stages, 0, sizeof(stats->span_stages));
+}
+
+void EventsStats_End(struct EventsStats *stats, enum EventsStats_Stage stage,
+	unsigned long long begin)
+{
+	unsigned long long duration;
+
+	if (!stats->enabled)
+		return;
+
+	assert(stage < EVENTSSTATS_TOTAL);
+	duration = EventsStats_Now() - begin;
+	stats->counters[stage].calls++;
+	stats->counters[stage].nanoseconds += duration;
+
+	if (!stats->trace_enabled)
+		return;
+	if (EventsStats_PerLine(stage))
+		stats->span_stages[stage] += duration;
+	else
+		EventsStats_AddSpan(stats, stage, begin, duration);
+}
+
+void EventsStats_Print(struct EventsStats *stats, FILE *output)
+{
+	struct EventsStats_Counter *counter;
+	size_t i;
+
+	fprintf(output, "%-10s %12s %12s %12s\n", 
+		"stage", "calls", "total ms", "average us");
+	for (i = 0; i < EVENTSSTATS_TOTAL; i++) {
+		counter = &stats->counters[i];
+		fprintf(output, "%-10s %12llu %12.3f %12.3f\n", 
+			EventsStats_StageName(i), counter->calls,
+			counter->nanoseconds / 1e6,
+			counter->calls ? counter->nanoseconds / 1e3 / counter->calls : 0.0);
+	}
+	fprintf(output, "lines %llu, bytes %llu, events %llu\n", 
+		stats->lines, stats->bytes, stats->events);
+}
+
+/* Chrome trace event format, loads in chrome://tracing and Perfetto */
+int EventsStats_WriteTrace(struct EventsStats *stats, const char *file_name)
+{
+	FILE *trace;
+	struct EventsStats_Span *span;
+	size_t i, j;
+
+	trace = fopen(file_name, "w");
+	if (NULL == trace)
+		return -1;
+
+	fprintf(trace, "{\"traceEvents\":[\n");
+	for (i = 0; i < stats->spans_length; i++) {
+		span = &stats->spans[i];
+		fprintf(trace, "%s{\"name\":\"%s\",\"cat\":\"eventsdb\","
+			"\"ph\":\"X\",\"pid\":1,\"tid\":1,"
+			"\"ts\":%.3f,\"dur\":%.3f,\"args\":{",
+			i ? ",\n" : "", EventsStats_StageName(span->stage),
+			span->begin / 1e3, span->duration / 1e3);
+		for (j = 0; j < EVENTSSTATS_TOTAL; j++) {
+			if (EVENTSSTATS_LOAD != span->stage || 
+			    !EventsStats_PerLine(j))
+				continue;
+			fprintf(trace, "%s\"%s_us\":%.3f", 
+				EVENTSSTATS_READ == j ? "" : ",",
+				EventsStats_StageName(j), span->stages[j] / 1e3);
+		}
+		fprintf(trace, "}}");
+	}
+	fprintf(trace, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+	fclose(trace);
+	return 0;
+}
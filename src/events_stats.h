@@ -0,0 +1,66 @@
+#ifndef __EVENTS_STATS__
+#define __EVENTS_STATS__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+enum EventsStats_Stage{
+	EVENTSSTATS_LOAD,	/* whole EventsDb_AddLog */
+	EVENTSSTATS_READ,
+	EVENTSSTATS_VALIDATE,
+	EVENTSSTATS_EXTRACT,
+	EVENTSSTATS_INDEX,
+	EVENTSSTATS_TABLE,
+	EVENTSSTATS_STORE,
+	EVENTSSTATS_TOTAL
+};
+
+struct EventsStats_Counter {
+	unsigned long long calls;
+	unsigned long long nanoseconds;
+};
+
+/* Trace viewer span, per line stages are folded into the load spans */
+struct EventsStats_Span {
+	enum EventsStats_Stage stage;
+	unsigned long long begin;
+	unsigned long long duration;
+	unsigned long long stages[EVENTSSTATS_TOTAL];
+};
+
+struct EventsStats {
+	bool enabled;
+	bool trace_enabled;
+	unsigned long long origin;
+
+	struct EventsStats_Counter counters[EVENTSSTATS_TOTAL];
+	unsigned long long lines;
+	unsigned long long bytes;
+	unsigned long long events;
+
+	struct EventsStats_Span *spans;
+	size_t spans_length;
+	size_t spans_capacity;
+	unsigned long long span_stages[EVENTSSTATS_TOTAL];
+};
+
+void EventsStats_Init(struct EventsStats *stats);
+
+void EventsStats_Done(struct EventsStats *stats);
+
+void EventsStats_Enable(struct EventsStats *stats, bool trace);
+
+const char *EventsStats_StageName(enum EventsStats_Stage stage);
+
+/* Returns 0 without reading the clock when statistics are disabled */
+unsigned long long EventsStats_Begin(struct EventsStats *stats);
+
+void EventsStats_End(struct EventsStats *stats, enum EventsStats_Stage stage,
+	unsigned long long begin);
+
+void EventsStats_Print(struct EventsStats *stats, FILE *output);
+
+int EventsStats_WriteTrace(struct EventsStats *stats, const char *file_name);
+
+#endif
@@ -0,0 +1,464 @@
+#include <assert.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "events_store.h"
+
+#define EVENTSSTORE_COLUMNS_INITIAL_SIZE 1024
+#define EVENTSSTORE_HEAP_INITIAL_SIZE (64 * 1024)
+#define EVENTSSTORE_SEGMENTS_INITIAL_SIZE 64
+/* Bytes of one event in the columns */
+#define EVENTSSTORE_EVENT_BYTES (3 * sizeof(uint64_t) + \
+	2 * sizeof(uint32_t) + sizeof(uint8_t))
+
+int EventsStore_Init(struct EventsStore *store, const char *directory,
+	size_t budget)
+{
+	memset(store, 0, sizeof(*store));
+	TAILQ_INIT(&store->lru);
+
+	if (0 != access(directory, W_OK | X_OK))
+		return -1;
+
+	store->directory = strdup(directory);
+	assert(NULL != store->directory);
+	store->budget = budget < EVENTSSTORE_MIN_BUDGET ?
+		EVENTSSTORE_MIN_BUDGET : budget;
+	store->segment_bytes = store->budget / EVENTSSTORE_SEGMENT_SHARE;
+	if (store->segment_bytes < EVENTSSTORE_SEGMENT_MIN)
+		store->segment_bytes = EVENTSSTORE_SEGMENT_MIN;
+	if (store->segment_bytes > EVENTSSTORE_SEGMENT_MAX)
+		store->segment_bytes = EVENTSSTORE_SEGMENT_MAX;
+	return 0;
+}
+
+static void EventsStore_Unmap(struct EventsStore *store,
+	struct EventsStore_Segment *segment)
+{
+	munmap((void *)segment->map, segment->size);
+	segment->map = NULL;
+	TAILQ_REMOVE(&store->lru, segment, lru);
+	store->mapped_bytes -= segment->size;
+	store->unmaps++;
+}
+
+void EventsStore_Done(struct EventsStore *store)
+{
+	struct EventsStore_Columns *open = &store->open;
+	struct EventsStore_Segment *segment;
+	size_t i;
+
+	for (i = 0; i < store->segments_count; i++) {
+		segment = store->segments[i];
+		if (NULL != segment->map)
+			EventsStore_Unmap(store, segment);
+		unlink(segment->file_name);
+		free(segment->file_name);
+		free(segment);
+	}
+	free(store->segments);
+
+	free(open->time);
+	free(open->time_text);
+	free(open->message);
+	free(open->marker);
+	free(open->path);
+	free(open->severity);
+	free(open->heap);
+	free(store->directory);
+	memset(store, 0, sizeof(*store));
+	TAILQ_INIT(&store->lru);
+}
+
+static void *EventsStore_Resize(void *column, size_t capacity, size_t size)
+{
+	column = realloc(column, capacity * size);
+	assert(NULL != column);
+	return column;
+}
+
+static void EventsStore_ColumnsGrow(struct EventsStore_Columns *open)
+{
+	open->capacity = open->capacity ?
+		open->capacity * 2 : EVENTSSTORE_COLUMNS_INITIAL_SIZE;
+	open->time = EventsStore_Resize(open->time,
+		open->capacity, sizeof(*open->time));
+	open->time_text = EventsStore_Resize(open->time_text,
+		open->capacity, sizeof(*open->time_text));
+	open->message = EventsStore_Resize(open->message,
+		open->capacity, sizeof(*open->message));
+	open->marker = EventsStore_Resize(open->marker,
+		open->capacity, sizeof(*open->marker));
+	open->path = EventsStore_Resize(open->path,
+		open->capacity, sizeof(*open->path));
+	open->severity = EventsStore_Resize(open->severity,
+		open->capacity, sizeof(*open->severity));
+}
+
+static uint64_t EventsStore_HeapAdd(struct EventsStore_Columns *open,
+	const char *string)
+{
+	size_t length = strlen(string) + 1;
+	uint64_t offset = open->heap_size;
+
+	if (open->heap_size + length > open->heap_capacity) {
+		if (0 == open->heap_capacity)
+			open->heap_capacity = EVENTSSTORE_HEAP_INITIAL_SIZE;
+		while (open->heap_size + length > open->heap_capacity)
+			open->heap_capacity *= 2;
+		open->heap = realloc(open->heap, open->heap_capacity);
+		assert(NULL != open->heap);
+	}
+	memcpy(&open->heap[open->heap_size], string, length);
+	open->heap_size += length;
+	return offset;
+}
+
+static int EventsStore_WriteColumns(struct EventsStore_Columns *open,
+	FILE *file)
+{
+	struct EventsStore_Header header;
+	size_t count = open->count;
+
+	header.magic = EVENTSSTORE_MAGIC;
+	header.count = count;
+	header.heap_size = open->heap_size;
+
+	if (1 != fwrite(&header, sizeof(header), 1, file) ||
+	    count != fwrite(open->time, sizeof(*open->time), count, file) ||
+	    count != fwrite(open->time_text, sizeof(*open->time_text), count, file) ||
+	    count != fwrite(open->message, sizeof(*open->message), count, file) ||
+	    count != fwrite(open->marker, sizeof(*open->marker), count, file) ||
+	    count != fwrite(open->path, sizeof(*open->path), count, file) ||
+	    count != fwrite(open->severity, sizeof(*open->severity), count, file) ||
+	    1 != fwrite(open->heap, open->heap_size, 1, file))
+		return -1;
+	return 0;
+}
+
+static struct EventsStore_Segment *EventsStore_NewSegment(
+	struct EventsStore *store)
+{
+	struct EventsStore_Columns *open = &store->open;
+	struct EventsStore_Segment *segment;
+	size_t i;
+
+	segment = calloc(1, sizeof(*segment));
+	assert(NULL != segment);
+	segment->file_name = malloc(strlen(store->directory) + 64);
+	assert(NULL != segment->file_name);
+	sprintf(segment->file_name, "%s/eventsview-%06zu-XXXXXX",
+		store->directory, store->segments_count);
+
+	segment->first = store->events;
+	segment->count = open->count;
+	segment->time_min = segment->time_max = open->time[0];
+	segment->sorted = true;
+	for (i = 1; i < open->count; i++) {
+		if (open->time[i] < open->time[i - 1])
+			segment->sorted = false;
+		if (open->time[i] < segment->time_min)
+			segment->time_min = open->time[i];
+		if (open->time[i] > segment->time_max)
+			segment->time_max = open->time[i];
+	}
+	segment->size = sizeof(struct EventsStore_Header) +
+		open->count * EVENTSSTORE_EVENT_BYTES + open->heap_size;
+	return segment;
+}
+
+/* Seals the open segment, its columns are reused for the next one */
+int EventsStore_Flush(struct EventsStore *store)
+{
+	struct EventsStore_Columns *open = &store->open;
+	struct EventsStore_Segment *segment;
+	FILE *file;
+	int fd, err;
+
+	if (0 == open->count)
+		return 0;
+
+	/* mkstemp creates a new file only readable by us, a name planted in 
+	 * a shared directory such as /tmp is never followed or truncated */
+	segment = EventsStore_NewSegment(store);
+	fd = mkstemp(segment->file_name);
+	if (-1 == fd) {
+		free(segment->file_name);
+		free(segment);
+		return -1;
+	}
+	file = fdopen(fd, "wb");
+	if (NULL == file) {
+		close(fd);
+		err = -1;
+	} else {
+		err = EventsStore_WriteColumns(open, file);
+		if (0 != fclose(file))
+			err = -1;
+	}
+	if (err) {
+		unlink(segment->file_name);
+		free(segment->file_name);
+		free(segment);
+		return -1;
+	}
+
+	if (store->segments_count == store->segments_capacity) {
+		store->segments_capacity = store->segments_capacity ?
+			store->segments_capacity * 2 :
+			EVENTSSTORE_SEGMENTS_INITIAL_SIZE;
+		store->segments = realloc(store->segments,
+			store->segments_capacity * sizeof(*store->segments));
+		assert(NULL != store->segments);
+	}
+	store->segments[store->segments_count++] = segment;
+	store->events += open->count;
+
+	open->count = 0;
+	open->heap_size = 0;
+	return 0;
+}
+
+/* The event stays in the open segment when sealing it fails, so it is
+ * stored either way and the next Append or Flush seals it again */
+int EventsStore_Append(struct EventsStore *store, unsigned long long time,
+	const char *time_text, const char *message, uint32_t marker,
+	uint32_t path, uint8_t severity)
+{
+	struct EventsStore_Columns *open = &store->open;
+	size_t i;
+
+	if (open->count == open->capacity)
+		EventsStore_ColumnsGrow(open);
+
+	i = open->count++;
+	open->time[i] = time;
+	open->time_text[i] = EventsStore_HeapAdd(open, time_text);
+	open->message[i] = EventsStore_HeapAdd(open, message);
+	open->marker[i] = marker;
+	open->path[i] = path;
+	open->severity[i] = severity;
+
+	if (open->count * EVENTSSTORE_EVENT_BYTES + open->heap_size >=
+	    store->segment_bytes)
+		return EventsStore_Flush(store);
+	return 0;
+}
+
+/* Events of sealed segments, the open one is not visible until flushed */
+size_t EventsStore_Count(struct EventsStore *store)
+{
+	return store->events;
+}
+
+static struct EventsStore_Segment *EventsStore_Find(struct EventsStore *store,
+	size_t event)
+{
+	size_t low = 0, high = store->segments_count, middle;
+	struct EventsStore_Segment *segment = store->current;
+
+	if (NULL != segment &&
+	    event >= segment->first && event < segment->first + segment->count)
+		return segment;
+
+	assert(event < store->events);
+	while (high - low > 1) {
+		middle = low + (high - low) / 2;
+		if (store->segments[middle]->first <= event)
+			low = middle;
+		else
+			high = middle;
+	}
+	store->current = store->segments[low];
+	return store->current;
+}
+
+/* Mapped bytes are kept under the budget left by the open segment, pinned
+ * segments are never unmapped and may exceed it */
+static int EventsStore_Map(struct EventsStore *store,
+	struct EventsStore_Segment *segment)
+{
+	struct EventsStore_Segment *victim, *next;
+	size_t limit;
+	void *map;
+	int fd;
+
+	if (NULL != segment->map) {
+		if (segment != TAILQ_LAST(&store->lru, segments_lru)) {
+			TAILQ_REMOVE(&store->lru, segment, lru);
+			TAILQ_INSERT_TAIL(&store->lru, segment, lru);
+		}
+		return 0;
+	}
+
+	limit = store->budget - store->segment_bytes;
+	for (victim = store->lru.tqh_first; victim != NULL &&
+	     store->mapped_bytes + segment->size > limit; victim = next) {
+		next = victim->lru.tqe_next;
+		if (0 == victim->pins)
+			EventsStore_Unmap(store, victim);
+	}
+
+	fd = open(segment->file_name, O_RDONLY | O_NOFOLLOW);
+	if (-1 == fd)
+		return -1;
+	map = mmap(NULL, segment->size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (MAP_FAILED == map)
+		return -1;
+
+	segment->map = map;
+	TAILQ_INSERT_TAIL(&store->lru, segment, lru);
+	store->mapped_bytes += segment->size;
+	store->maps++;
+	return 0;
+}
+
+int EventsStore_Get(struct EventsStore *store, size_t event,
+	struct EventsStore_Event *result)
+{
+	struct EventsStore_Segment *segment;
+	const char *columns, *heap;
+	size_t count, i;
+
+	segment = EventsStore_Find(store, event);
+	if (EventsStore_Map(store, segment))
+		return -1;
+
+	count = segment->count;
+	i = event - segment->first;
+	columns = segment->map + sizeof(struct EventsStore_Header);
+	heap = columns + count * EVENTSSTORE_EVENT_BYTES;
+
+	result->time = ((const uint64_t *)columns)[i];
+	result->time_text = heap +
+		((const uint64_t *)columns)[count + i];
+	result->message = heap +
+		((const uint64_t *)columns)[2 * count + i];
+	columns += 3 * count * sizeof(uint64_t);
+	result->marker = ((const uint32_t *)columns)[i];
+	result->path = ((const uint32_t *)columns)[count + i];
+	columns += 2 * count * sizeof(uint32_t);
+	result->severity = ((const uint8_t *)columns)[i];
+	return 0;
+}
+
+/* Strings of pinned events stay mapped until they are unpinned */
+void EventsStore_Pin(struct EventsStore *store, size_t first, size_t last)
+{
+	struct EventsStore_Segment *segment;
+
+	while (first < last) {
+		segment = EventsStore_Find(store, first);
+		segment->pins++;
+		first = segment->first + segment->count;
+	}
+}
+
+void EventsStore_Unpin(struct EventsStore *store, size_t first, size_t last)
+{
+	struct EventsStore_Segment *segment;
+
+	while (first < last) {
+		segment = EventsStore_Find(store, first);
+		assert(segment->pins > 0);
+		segment->pins--;
+		first = segment->first + segment->count;
+	}
+}
+
+/* End of a window of at most events from first, the segments it spans take
+ * at most half of the budget so that the window can stay pinned */
+size_t EventsStore_WindowEnd(struct EventsStore *store, size_t first,
+	size_t events)
+{
+	struct EventsStore_Segment *segment, *next;
+	size_t last, bytes;
+
+	last = (store->events - first > events) ? first + events : store->events;
+	if (first == last)
+		return last;
+
+	segment = EventsStore_Find(store, first);
+	bytes = segment->size;
+	while (segment->first + segment->count < last) {
+		next = EventsStore_Find(store, segment->first + segment->count);
+		if (bytes + next->size > store->budget / 2)
+			return next->first;
+		bytes += next->size;
+		segment = next;
+	}
+	return last;
+}
+
+/* Start of a window of at most events before last, the mirror of
+ * EventsStore_WindowEnd */
+size_t EventsStore_WindowStart(struct EventsStore *store, size_t last,
+	size_t events)
+{
+	struct EventsStore_Segment *segment, *previous;
+	size_t first, bytes;
+
+	first = (last > events) ? last - events : 0;
+	if (first == last)
+		return first;
+
+	segment = EventsStore_Find(store, last - 1);
+	bytes = segment->size;
+	while (segment->first > first) {
+		previous = EventsStore_Find(store, segment->first - 1);
+		if (bytes + previous->size > store->budget / 2)
+			return segment->first;
+		bytes += previous->size;
+		segment = previous;
+	}
+	return first;
+}
+
+/* First event in the log order at or after time, only segments whose time
+ * range covers it are paged in */
+size_t EventsStore_FindTime(struct EventsStore *store, unsigned long long time)
+{
+	struct EventsStore_Segment *segment;
+	struct EventsStore_Event event;
+	size_t i, low, high, middle;
+
+	for (i = 0; i < store->segments_count; i++) {
+		segment = store->segments[i];
+		if (segment->time_max < time)
+			continue;
+		if (segment->time_min >= time)
+			return segment->first;
+
+		low = segment->first;
+		high = segment->first + segment->count;
+		if (!segment->sorted) {
+			for (; low < high; low++)
+				if (0 == EventsStore_Get(store, low, &event) &&
+				    event.time >= time)
+					break;
+			return low;
+		}
+		while (low < high) {
+			middle = low + (high - low) / 2;
+			if (0 == EventsStore_Get(store, middle, &event) &&
+			    event.time < time)
+				low = middle + 1;
+			else
+				high = middle;
+		}
+		return low;
+	}
+	return store->events;
+}
+
+void EventsStore_Print(struct EventsStore *store, FILE *output)
+{
+	fprintf(output, "store: %zu events in %zu segments, budget %zu bytes, "
+		"segment %zu bytes\n", store->events, store->segments_count,
+		store->budget, store->segment_bytes);
+	fprintf(output, "store: %zu bytes mapped, %zu maps, %zu unmaps\n",
+		store->mapped_bytes, store->maps, store->unmaps);
+}
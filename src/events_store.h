@@ -0,0 +1,124 @@
+#ifndef __EVENTS_STORE__
+#define __EVENTS_STORE__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/queue.h>
+
+#define EVENTSSTORE_MAGIC 0x53564545u
+#define EVENTSSTORE_MIN_BUDGET (1024 * 1024)
+/* A segment is sealed once its columns and strings reach this share of
+ * the budget, bounded by the sizes below */
+#define EVENTSSTORE_SEGMENT_SHARE 8
+#define EVENTSSTORE_SEGMENT_MIN   (64 * 1024)
+#define EVENTSSTORE_SEGMENT_MAX   (64 * 1024 * 1024)
+
+/* Segment file layout, the header is followed by the columns
+ *   uint64_t time[count], time_text[count], message[count]
+ *   uint32_t marker[count], path[count]
+ *   uint8_t  severity[count]
+ * and by the string heap that time_text and message point into */
+struct EventsStore_Header {
+	uint32_t magic;
+	uint32_t count;
+	uint64_t heap_size;
+};
+
+/* Events of the segment being written */
+struct EventsStore_Columns {
+	uint64_t *time;
+	uint64_t *time_text;
+	uint64_t *message;
+	uint32_t *marker;
+	uint32_t *path;
+	uint8_t *severity;
+	size_t count;
+	size_t capacity;
+
+	char *heap;
+	size_t heap_size;
+	size_t heap_capacity;
+};
+
+TAILQ_HEAD(segments_lru, EventsStore_Segment);
+struct EventsStore_Segment {
+	TAILQ_ENTRY(EventsStore_Segment) lru;
+	char *file_name;
+
+	/* Sparse time index: the store keeps only these in memory */
+	size_t first;
+	size_t count;
+	unsigned long long time_min;
+	unsigned long long time_max;
+	bool sorted;
+
+	size_t size;
+	const char *map;	/* NULL when paged out */
+	unsigned int pins;
+};
+
+struct EventsStore_Event {
+	unsigned long long time;
+	const char *time_text;
+	const char *message;
+	uint32_t marker;
+	uint32_t path;
+	uint8_t severity;
+};
+
+/* Events spilled to column segments in a directory, segments are mapped on
+ * demand and the least recently used unpinned ones are unmapped to keep
+ * the memory under the budget */
+struct EventsStore {
+	char *directory;
+	size_t budget;
+	size_t segment_bytes;
+
+	struct EventsStore_Columns open;
+
+	struct EventsStore_Segment **segments;
+	size_t segments_count;
+	size_t segments_capacity;
+	size_t events;
+	struct EventsStore_Segment *current;
+
+	/* Mapped segments, least recently used first */
+	struct segments_lru lru;
+	size_t mapped_bytes;
+	size_t maps;
+	size_t unmaps;
+};
+
+int EventsStore_Init(struct EventsStore *store, const char *directory,
+	size_t budget);
+
+void EventsStore_Done(struct EventsStore *store);
+
+int EventsStore_Append(struct EventsStore *store, unsigned long long time,
+	const char *time_text, const char *message, uint32_t marker,
+	uint32_t path, uint8_t severity);
+
+int EventsStore_Flush(struct EventsStore *store);
+
+size_t EventsStore_Count(struct EventsStore *store);
+
+int EventsStore_Get(struct EventsStore *store, size_t event,
+	struct EventsStore_Event *result);
+
+void EventsStore_Pin(struct EventsStore *store, size_t first, size_t last);
+
+void EventsStore_Unpin(struct EventsStore *store, size_t first, size_t last);
+
+size_t EventsStore_WindowEnd(struct EventsStore *store, size_t first,
+	size_t events);
+
+size_t EventsStore_WindowStart(struct EventsStore *store, size_t last,
+	size_t events);
+
+size_t EventsStore_FindTime(struct EventsStore *store, unsigned long long time);
+
+void EventsStore_Print(struct EventsStore *store, FILE *output);
+
+#endif
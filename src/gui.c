@@ -1,31 +1,96 @@
 #include <assert.h>
 #include <gtk/gtk.h>
 #include <gio/gio.h>
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include "events_db.h"
 #include "gui.h"
 
 #define MARKER_MAXIMUM_SIZE 1024
+#define SEVERITY_DATA_KEY "severity-bit"
+#define OVERVIEW_HEIGHT 48
+#define OVERVIEW_MIN_SPAN 16
+#define DIFF_HIGHLIGHT_COLOR "#ffc0c0"
 
 enum {
 	MARKERS_CHECK,
 	MARKERS_NAME,
+	MARKERS_PATH,
 	MARKERS_TOTAL
 } TypesFields;
 
+/* Row of the first diverging event of a marker column in a runs diff */
+struct DiffHighlight {
+	size_t row;
+};
+
 struct Session{
 	struct EventsDb *eventsdb;
 	GtkWidget *markers_tree_view;
 	GtkWidget *events_tree_view;
 	GtkWidget *events_tree_view_parent;
+	GtkWidget *overview;
+	size_t overview_first; /* level 0 density buckets */
+	size_t overview_span;
+	bool paging;	/* out-of-core table window is being replaced */
+	bool load_failed;	/* a log is partly stored, tables stay empty */
 };
 
+static const char *gui_error_text(enum EventsDb_Error err)
+{
+	switch (err) {
+	case EVENTSDB_CANT_OPEN:
+		return "can't open the log";
+	case EVENTSDB_NOT_ENOUGHT_MEM:
+		return "not enough memory";
+	case EVENTSDB_STORE_FAILED:
+		return "the event store failed, check the store directory";
+	default:
+		return "unexpected error";
+	}
+}
+
+/* Reported on stdout too, the dialog doesn't block the caller */
+static void gui_show_error(const char *what, enum EventsDb_Error err)
+{
+	GtkWidget *dialog;
+
+	printf("%s: %s\n", what, gui_error_text(err));
+	dialog = gtk_message_dialog_new(NULL, 0, GTK_MESSAGE_ERROR, 
+		GTK_BUTTONS_CLOSE, "%s", what);
+	gtk_message_dialog_format_secondary_text(GTK_MESSAGE_DIALOG(dialog),
+		"%s", gui_error_text(err));
+	g_signal_connect_swapped(dialog, "response", 
+		G_CALLBACK(gtk_widget_destroy), dialog);
+	gtk_widget_show(dialog);
+}
+
+static void paths_load_store(GtkTreeStore *markers_store, GtkTreeIter *parent,
+	struct EventsPaths_Node *node)
+{
+	GtkTreeIter iter;
+	gchar *name;
+
+	name = g_strdup_printf("%s (%zu)", node->name, node->subtree_events);
+	gtk_tree_store_append(markers_store, &iter, parent);
+	gtk_tree_store_set(markers_store, &iter,
+		MARKERS_CHECK, node->enabled,
+		MARKERS_NAME, name,
+		MARKERS_PATH, node,
+		-1);
+	g_free(name);
+
+	for (node = node->children; node != NULL; node = node->next)
+		paths_load_store(markers_store, &iter, node);
+}
+
 static void markers_load_store(GtkTreeStore *markers_store, struct EventsDb *eventsdb)
 {
 	GtkTreeIter iter;
 	struct markers_queue *m_queue;
 	struct markers_queue_entry *m_entry;
+	struct EventsPaths_Node *root;
 
 	m_queue = EventsDb_GetMarkersQueue(eventsdb);
 	for (m_entry = m_queue->tqh_first; m_entry != NULL; 
@@ -34,8 +99,27 @@ static void markers_load_store(GtkTreeStore *markers_store, struct EventsDb *eve
 		gtk_tree_store_set(markers_store, &iter,
 			MARKERS_CHECK, TRUE,
 			MARKERS_NAME, m_entry->marker,
+			MARKERS_PATH, NULL,
 			-1);
 	}
+
+	root = EventsPaths_GetRoot(EventsDb_GetPaths(eventsdb));
+	if (NULL != root->children)
+		paths_load_store(markers_store, NULL, root);
+}
+
+static void paths_set_store_enabled(GtkTreeStore *markers_store, 
+	GtkTreeIter *iter, gboolean enabled)
+{
+	GtkTreeIter child;
+
+	gtk_tree_store_set(markers_store, iter, MARKERS_CHECK, enabled, -1);
+	if (!gtk_tree_model_iter_children(GTK_TREE_MODEL(markers_store), 
+	    &child, iter))
+		return;
+	do {
+		paths_set_store_enabled(markers_store, &child, enabled);
+	} while (gtk_tree_model_iter_next(GTK_TREE_MODEL(markers_store), &child));
 }
 
 static void markers_data_func(__attribute__((unused))GtkTreeViewColumn *column,
@@ -54,13 +138,17 @@ static int markers_count(GtkTreeModel *model)
 	int count = 0;
 	GtkTreeIter iter;
 	gboolean enabled;
+	gpointer path;
 
 	if (!gtk_tree_model_get_iter_first(model, &iter))
 		return 0;
 
 	while(1) {
-		gtk_tree_model_get(model, &iter, MARKERS_CHECK, &enabled, -1);
-		if (enabled)
+		gtk_tree_model_get(model, &iter, 
+			MARKERS_CHECK, &enabled, 
+			MARKERS_PATH, &path,
+			-1);
+		if (enabled && NULL == path)
 			count++;
 		if (!gtk_tree_model_iter_next(model, &iter))
 			break;
@@ -74,14 +162,18 @@ static void markers_create_enabled_list(GtkTreeModel *model,
 	GtkTreeIter iter;
 	gboolean enabled;
 	gchar *marker_name;
+	gpointer path;
 	int i = 0;
 
 	if (!gtk_tree_model_get_iter_first(model, &iter))
 		return;
 
 	while(1) {
-		gtk_tree_model_get(model, &iter, MARKERS_CHECK, &enabled, -1);
-		if (enabled) {
+		gtk_tree_model_get(model, &iter, 
+			MARKERS_CHECK, &enabled, 
+			MARKERS_PATH, &path,
+			-1);
+		if (enabled && NULL == path) {
 			gtk_tree_model_get(model, &iter, 
 				MARKERS_NAME, &marker_name, -1);
 			markers_list[i++] = marker_name;
@@ -116,7 +208,11 @@ static void events_init_store_content(GtkTreeStore *store, struct EventsDb *even
 	GtkTreeIter iter;
 	const char *value;
 	GValue *value_container;
+	struct EventsStats *stats;
+	unsigned long long begin;
 
+	stats = EventsDb_GetStats(eventsdb);
+	begin = EventsStats_Begin(stats);
 	columns = EventsDb_ResponseGetColumns(eventsdb);
 	rows = EventsDb_ResponseGetRows(eventsdb);
 	for (row_i = 0; row_i < rows; row_i++) {
@@ -136,8 +232,10 @@ static void events_init_store_content(GtkTreeStore *store, struct EventsDb *even
 				column_i, value_container);
 		}
 	}
+	EventsStats_End(stats, EVENTSSTATS_STORE, begin);
 }
 
+/* NULL when the table can't be built, the error is shown */
 static GtkTreeStore *events_init_store(struct EventsDb *eventsdb, 
 	GtkTreeModel *markers_model)
 {
@@ -154,7 +252,12 @@ static GtkTreeStore *events_init_store(struct EventsDb *eventsdb,
 	markers_create_enabled_list(markers_model, markers, markers_length);
 	EventsDb_ResponseFreeMemory(eventsdb);
 	err_evdb = EventsDb_RequestEventsTable(eventsdb, markers, markers_length);
-	assert(EVENTSDB_OK == err_evdb);
+	free(markers);
+	if (EVENTSDB_OK != err_evdb) {
+		EventsDb_ResponseFreeMemory(eventsdb);
+		gui_show_error("Can't build the events table", err_evdb);
+		return NULL;
+	}
 	eventsdb->response_markers_count = markers_length;
 	store = events_init_store_types(EventsDb_ResponseGetColumns(eventsdb)); 
 	events_init_store_content(store, eventsdb);
@@ -162,44 +265,105 @@ static GtkTreeStore *events_init_store(struct EventsDb *eventsdb,
 	return store;
 }
 
-static void events_init_view(GtkWidget *events_tree_view, struct EventsDb *eventsdb)
+static void events_diff_cell_cb(
+	__attribute__((unused))GtkTreeViewColumn *column, 
+	GtkCellRenderer *renderer, GtkTreeModel *model, GtkTreeIter *iter, 
+	gpointer user_data)
+{
+	struct DiffHighlight *highlight;
+	GtkTreePath *path;
+	gboolean first;
+
+	highlight = (struct DiffHighlight *)user_data;
+	path = gtk_tree_model_get_path(model, iter);
+	first = (size_t)gtk_tree_path_get_indices(path)[0] == highlight->row;
+	g_object_set(renderer, "background-set", first, NULL);
+	gtk_tree_path_free(path);
+}
+
+/* Columns of markers that diverge between the runs get their own renderer
+ * to highlight the row of the first diverging event */
+static GtkTreeViewColumn *events_diff_column(struct EventsDb *eventsdb, 
+	const char *column_name, int column_index)
+{
+	struct DiffHighlight *highlight;
+	GtkCellRenderer *render_text;
+	GtkTreeViewColumn *column;
+	size_t row;
+
+	row = EventsDb_ResponseDivergingRow(eventsdb, column_index - 1);
+	if (EVENTSDB_NONE == row)
+		return NULL;
+
+	render_text = gtk_cell_renderer_text_new();
+	g_object_set(render_text, "background", DIFF_HIGHLIGHT_COLOR, NULL);
+	column = gtk_tree_view_column_new_with_attributes(
+		column_name, render_text, "text", column_index, NULL);
+
+	highlight = g_new(struct DiffHighlight, 1);
+	highlight->row = row;
+	gtk_tree_view_column_set_cell_data_func(column, render_text, 
+		events_diff_cell_cb, highlight, g_free);
+	return column;
+}
+
+/* Without markers_count only the time column is shown */
+static void events_init_view(GtkWidget *events_tree_view, struct EventsDb *eventsdb,
+	size_t markers_count)
 {
 	GtkCellRenderer *render_text;
 	GtkTreeViewColumn *column;
-	size_t i, markers_count;
+	size_t i;
 	char *column_name;
 
-	markers_count = EventsDb_ResponseMarkersCount(eventsdb);
 	render_text = gtk_cell_renderer_text_new();
 	for (i = 0; i < markers_count + 1; i++) {
 		column_name = (i == 0) ? 
 			"Time" : EventsDb_ResponseMarkerAt(eventsdb, i - 1);
-		column = gtk_tree_view_column_new_with_attributes(
-			column_name, render_text, "text", i, NULL);
+		column = (i == 0) ? NULL : 
+			events_diff_column(eventsdb, column_name, i);
+		if (NULL == column)
+			column = gtk_tree_view_column_new_with_attributes(
+				column_name, render_text, "text", i, NULL);
 		gtk_tree_view_append_column(GTK_TREE_VIEW(events_tree_view),
 			column);
 	}
 }
 
-static GtkWidget *events_create_view(GtkWidget *parent, 
-	GtkWidget *markers_tree_view, struct EventsDb *eventsdb)
+/* A failed table or load leaves an empty table */
+static GtkWidget *events_create_view(struct Session *info)
 {
+	struct EventsDb *eventsdb = info->eventsdb;
 	GtkTreeModel *model;
 	GtkWidget *events_tree_view;
-	GtkTreeStore *events_store;
-
-	model = gtk_tree_view_get_model(GTK_TREE_VIEW(markers_tree_view));
-	events_store = events_init_store(eventsdb, model);
+	GtkTreeStore *events_store = NULL;
+	size_t markers_count = 0;
+
+	model = gtk_tree_view_get_model(GTK_TREE_VIEW(info->markers_tree_view));
+	if (!info->load_failed)
+		events_store = events_init_store(eventsdb, model);
+	if (NULL != events_store)
+		markers_count = EventsDb_ResponseMarkersCount(eventsdb);
+	else
+		events_store = events_init_store_types(1);
 	events_tree_view = gtk_tree_view_new_with_model(GTK_TREE_MODEL(events_store));
-	events_init_view(events_tree_view, eventsdb);
+	events_init_view(events_tree_view, eventsdb, markers_count);
 	gtk_tree_view_set_grid_lines(GTK_TREE_VIEW(events_tree_view),
 		GTK_TREE_VIEW_GRID_LINES_BOTH);
-	gtk_container_add(GTK_CONTAINER(parent), events_tree_view);
+	gtk_container_add(GTK_CONTAINER(info->events_tree_view_parent), 
+		events_tree_view);
 	gtk_widget_show(events_tree_view);
 
 	return events_tree_view;
 }
 
+static void events_refresh_view(struct Session *info)
+{
+	gtk_widget_destroy(info->events_tree_view);
+	info->events_tree_view = events_create_view(info);
+	gtk_widget_queue_draw(info->overview);
+}
+
 void markers_toggled_cb(__attribute__((unused))GtkCellRendererToggle* renderer, 
 	gchar* pathStr, gpointer user_data)
 {
@@ -208,6 +372,7 @@ void markers_toggled_cb(__attribute__((unused))GtkCellRendererToggle* renderer,
 	GtkTreeIter iter;
 	GtkTreeModel *markers_model;
 	gboolean enabled;
+	gpointer path_node;
 
 	info = (struct Session *)user_data;
 	markers_model = gtk_tree_view_get_model(GTK_TREE_VIEW(info->markers_tree_view));
@@ -216,15 +381,40 @@ void markers_toggled_cb(__attribute__((unused))GtkCellRendererToggle* renderer,
 	gtk_tree_model_get_iter(markers_model, &iter, path);
 	gtk_tree_model_get(markers_model, &iter, 
 		MARKERS_CHECK, &enabled, 
+		MARKERS_PATH, &path_node,
 		-1);
+	gtk_tree_path_free(path);
 
 	enabled = !enabled;
-	gtk_tree_store_set(GTK_TREE_STORE(markers_model), &iter, 
-		MARKERS_CHECK, enabled, -1);
+	if (NULL != path_node) {
+		EventsPaths_SetEnabled(EventsDb_GetPaths(info->eventsdb), 
+			path_node, enabled);
+		paths_set_store_enabled(GTK_TREE_STORE(markers_model), 
+			&iter, enabled);
+	} else
+		gtk_tree_store_set(GTK_TREE_STORE(markers_model), &iter, 
+			MARKERS_CHECK, enabled, -1);
+
+	events_refresh_view(info);
+}
 
-	gtk_widget_destroy(info->events_tree_view);
-	info->events_tree_view = events_create_view(info->events_tree_view_parent,
-		info->markers_tree_view, info->eventsdb);
+void severity_toggled_cb(GtkToggleButton *button, gpointer user_data)
+{
+	struct Session *info;
+	unsigned int mask, severity_bit;
+
+	info = (struct Session *)user_data;
+	severity_bit = GPOINTER_TO_UINT(
+		g_object_get_data(G_OBJECT(button), SEVERITY_DATA_KEY));
+
+	mask = EventsDb_GetSeverityMask(info->eventsdb);
+	if (gtk_toggle_button_get_active(button))
+		mask |= severity_bit;
+	else
+		mask &= ~severity_bit;
+	EventsDb_SetSeverityMask(info->eventsdb, mask);
+
+	events_refresh_view(info);
 }
 
 static GtkWidget *markers_init_view(GtkTreeStore *markers_store, 
@@ -268,7 +458,7 @@ static GtkWidget *activate_markers_view(struct Session *info)
 	gtk_widget_show(markers_view_scroll);
 
 	markers_store = gtk_tree_store_new(MARKERS_TOTAL, 
-		G_TYPE_BOOLEAN, G_TYPE_STRING);
+		G_TYPE_BOOLEAN, G_TYPE_STRING, G_TYPE_POINTER);
 	markers_load_store(markers_store, info->eventsdb);
 
 	info->markers_tree_view = markers_init_view(markers_store, info);
@@ -279,18 +469,282 @@ static GtkWidget *activate_markers_view(struct Session *info)
 	return markers_view_scroll;
 }
 
+static GtkWidget *activate_severity_view(struct Session *info)
+{
+	GtkWidget *severity_box;
+	GtkWidget *severity_check;
+	gchar *label;
+	unsigned int severity;
+
+	severity_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 0);
+	gtk_widget_show(severity_box);
+
+	for (severity = 0; severity < EVENTSDB_SEVERITY_TOTAL; severity++) {
+		label = g_strdup_printf("%s (%zu)", 
+			EventsDb_SeverityName(severity),
+			EventsDb_SeverityCount(info->eventsdb, severity));
+		severity_check = gtk_check_button_new_with_label(label);
+		g_free(label);
+
+		gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(severity_check),
+			0 != (EventsDb_GetSeverityMask(info->eventsdb) & 
+			      (1u << severity)));
+		g_object_set_data(G_OBJECT(severity_check), SEVERITY_DATA_KEY,
+			GUINT_TO_POINTER(1u << severity));
+		g_signal_connect(severity_check, "toggled", 
+			(GCallback)severity_toggled_cb, info);
+		gtk_box_pack_start(GTK_BOX(severity_box), severity_check, 
+			FALSE, FALSE, 0);
+		gtk_widget_show(severity_check);
+	}
+
+	return severity_box;
+}
+
+static GtkWidget *activate_filters_view(struct Session *info)
+{
+	GtkWidget *filters_box;
+
+	filters_box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
+	gtk_widget_show(filters_box);
+
+	gtk_box_pack_start(GTK_BOX(filters_box), activate_severity_view(info),
+		FALSE, FALSE, 0);
+	gtk_box_pack_start(GTK_BOX(filters_box), activate_markers_view(info),
+		TRUE, TRUE, 0);
+
+	return filters_box;
+}
+
+/* Coarsest level that still gives every pixel at most one bucket */
+static size_t overview_level(struct Session *info, int width)
+{
+	size_t level = 0;
+	size_t levels = EventsDb_DensityLevels(info->eventsdb);
+
+	while (level + 1 < levels && (info->overview_span >> level) > (size_t)width)
+		level++;
+	return level;
+}
+
+/* Unfiltered: severity and path filters don't change the strip */
+static unsigned int overview_bucket_count(struct Session *info, 
+	size_t level, size_t bucket)
+{
+	return EventsDb_ResponseDensityAt(info->eventsdb, level, bucket);
+}
+
+static size_t overview_bucket_at(struct Session *info, GtkWidget *widget, 
+	gdouble x)
+{
+	int width;
+
+	width = gtk_widget_get_allocated_width(widget);
+	if (width <= 0 || x < 0)
+		return info->overview_first;
+	return info->overview_first + (size_t)(x / width * info->overview_span);
+}
+
+static gboolean overview_draw_cb(GtkWidget *widget, cairo_t *cr, 
+	gpointer user_data)
+{
+	struct Session *info;
+	int width, height;
+	size_t level, first, last, bucket;
+	unsigned int count, count_max = 0;
+	double bar_width, bar_height;
+
+	info = (struct Session *)user_data;
+	width = gtk_widget_get_allocated_width(widget);
+	height = gtk_widget_get_allocated_height(widget);
+
+	cairo_set_source_rgb(cr, 1.0, 1.0, 1.0);
+	cairo_paint(cr);
+
+	level = overview_level(info, width);
+	first = info->overview_first >> level;
+	last = (info->overview_first + info->overview_span) >> level;
+	last = MIN(last, EventsDb_DensityBuckets(info->eventsdb, level));
+	if (last <= first)
+		return FALSE;
+
+	for (bucket = first; bucket < last; bucket++) {
+		count = overview_bucket_count(info, level, bucket);
+		count_max = MAX(count, count_max);
+	}
+	if (0 == count_max)
+		return FALSE;
+
+	bar_width = (double)width / MAX(info->overview_span >> level, 1);
+	cairo_set_source_rgb(cr, 0.2, 0.4, 0.8);
+	for (bucket = first; bucket < last; bucket++) {
+		count = overview_bucket_count(info, level, bucket);
+		bar_height = (double)height * count / count_max;
+		cairo_rectangle(cr, (bucket - first) * bar_width, 
+			height - bar_height, MAX(bar_width, 1.0), bar_height);
+	}
+	cairo_fill(cr);
+
+	return FALSE;
+}
+
+static void events_scroll_to_row(struct Session *info, size_t row)
+{
+	GtkTreePath *path;
+
+	if (row >= EventsDb_ResponseGetRows(info->eventsdb))
+		return;
+
+	path = gtk_tree_path_new_from_indices(row, -1);
+	gtk_tree_view_scroll_to_cell(GTK_TREE_VIEW(info->events_tree_view), 
+		path, NULL, TRUE, 0.0, 0.0);
+	gtk_tree_view_set_cursor(GTK_TREE_VIEW(info->events_tree_view), 
+		path, NULL, FALSE);
+	gtk_tree_path_free(path);
+}
+
+/* Out of core the table holds a window of events, a new one is requested
+ * from event on or, when before, up to event */
+static void events_page(struct Session *info, size_t event, bool before)
+{
+	if (before)
+		EventsDb_SetWindowBefore(info->eventsdb, event);
+	else
+		EventsDb_SetWindow(info->eventsdb, event);
+	info->paging = true;
+	events_refresh_view(info);
+	info->paging = false;
+}
+
+static gboolean overview_button_press_cb(GtkWidget *widget, 
+	GdkEventButton *event, gpointer user_data)
+{
+	struct Session *info;
+	unsigned long long time;
+	size_t first_event;
+
+	info = (struct Session *)user_data;
+	time = overview_bucket_at(info, widget, event->x) * 
+		EventsDb_DensityBucketWidth(info->eventsdb, 0);
+
+	if (EventsDb_IsWindowed(info->eventsdb)) {
+		first_event = EventsDb_EventAtTime(info->eventsdb, time);
+		if (first_event < EventsDb_WindowFirst(info->eventsdb) ||
+		    first_event >= EventsDb_WindowLast(info->eventsdb))
+			events_page(info, first_event, false);
+	}
+
+	events_scroll_to_row(info, 
+		EventsDb_ResponseRowAtTime(info->eventsdb, time));
+	return TRUE;
+}
+
+static gboolean overview_scroll_cb(GtkWidget *widget, GdkEventScroll *event, 
+	gpointer user_data)
+{
+	struct Session *info;
+	size_t pointer, buckets;
+
+	info = (struct Session *)user_data;
+	buckets = EventsDb_DensityBuckets(info->eventsdb, 0);
+	pointer = overview_bucket_at(info, widget, event->x);
+
+	if (GDK_SCROLL_UP == event->direction && 
+	    info->overview_span > OVERVIEW_MIN_SPAN)
+		info->overview_span /= 2;
+	else if (GDK_SCROLL_DOWN == event->direction && 
+		 info->overview_span < buckets)
+		info->overview_span = MIN(info->overview_span * 2, buckets);
+	else
+		return TRUE;
+
+	info->overview_first = (pointer > info->overview_span / 2) ?
+		pointer - info->overview_span / 2 : 0;
+	if (info->overview_first + info->overview_span > buckets)
+		info->overview_first = buckets > info->overview_span ? 
+			buckets - info->overview_span : 0;
+
+	gtk_widget_queue_draw(widget);
+	return TRUE;
+}
+
+static GtkWidget *activate_overview(struct Session *info)
+{
+	GtkWidget *overview;
+
+	info->overview_first = 0;
+	info->overview_span = EventsDb_DensityBuckets(info->eventsdb, 0);
+
+	overview = gtk_drawing_area_new();
+	gtk_widget_set_size_request(overview, -1, OVERVIEW_HEIGHT);
+	gtk_widget_add_events(overview, 
+		GDK_BUTTON_PRESS_MASK | GDK_SCROLL_MASK);
+	g_signal_connect(overview, "draw", 
+		G_CALLBACK(overview_draw_cb), info);
+	g_signal_connect(overview, "button-press-event", 
+		G_CALLBACK(overview_button_press_cb), info);
+	g_signal_connect(overview, "scroll-event", 
+		G_CALLBACK(overview_scroll_cb), info);
+	gtk_widget_show(overview);
+
+	info->overview = overview;
+	return overview;
+}
+
+/* Scrolling past the ends of an out-of-core table pages the neighbour
+ * window in, edges reached while the view is rebuilt are ignored */
+static void events_edge_reached_cb(
+	__attribute__((unused))GtkScrolledWindow *scrolled_window, 
+	GtkPositionType position, gpointer user_data)
+{
+	struct Session *info;
+	struct EventsDb *eventsdb;
+	GdkEvent *current_event;
+	size_t first, last;
+
+	info = (struct Session *)user_data;
+	eventsdb = info->eventsdb;
+	if (!EventsDb_IsWindowed(eventsdb) || info->paging)
+		return;
+	current_event = gtk_get_current_event();
+	if (NULL == current_event)
+		return;
+	gdk_event_free(current_event);
+
+	first = EventsDb_WindowFirst(eventsdb);
+	last = EventsDb_WindowLast(eventsdb);
+	if (GTK_POS_BOTTOM == position && last < EventsDb_EventsCount(eventsdb)) {
+		events_page(info, last, false);
+		events_scroll_to_row(info, 0);
+	} else if (GTK_POS_TOP == position && first > 0) {
+		events_page(info, first, true);
+		events_scroll_to_row(info, 
+			EventsDb_ResponseGetRows(eventsdb) - 1);
+	}
+}
+
 static GtkWidget *activate_events_view(struct Session *info)
 {
+	GtkWidget *events_box;
 	GtkWidget *events_list_scroll;
 
+	events_box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
+	gtk_widget_show(events_box);
+
 	events_list_scroll = gtk_scrolled_window_new(NULL, NULL);
 	gtk_widget_show(events_list_scroll);
 	info->events_tree_view_parent = events_list_scroll;
+	g_signal_connect(events_list_scroll, "edge-reached", 
+		G_CALLBACK(events_edge_reached_cb), info);
+
+	info->events_tree_view = events_create_view(info);
 
-	info->events_tree_view = events_create_view(info->events_tree_view_parent,
-		info->markers_tree_view, info->eventsdb);
+	gtk_box_pack_start(GTK_BOX(events_box), activate_overview(info), 
+		FALSE, FALSE, 0);
+	gtk_box_pack_start(GTK_BOX(events_box), info->events_tree_view_parent, 
+		TRUE, TRUE, 0);
 
-	return info->events_tree_view_parent;
+	return events_box;
 }
 
 static void gui_startup(
@@ -312,7 +766,7 @@ static void gui_open_new(GtkApplication *app, gpointer user_data)
 	gtk_container_add(GTK_CONTAINER(window), main_panels);
 	gtk_widget_show(main_panels);
 
-	gtk_paned_add1(GTK_PANED(main_panels), activate_markers_view(user_data));
+	gtk_paned_add1(GTK_PANED(main_panels), activate_filters_view(user_data));
 	gtk_paned_add2(GTK_PANED(main_panels), activate_events_view(user_data));
 
 	gtk_window_set_application(GTK_WINDOW(window), app);
@@ -322,17 +776,30 @@ static void gui_open_new(GtkApplication *app, gpointer user_data)
 static void gui_open(GApplication *application, gpointer *files, gint n_files, 
 	__attribute__((unused))gchar *hint, gpointer user_data)
 {
+	enum EventsDb_Error err = EVENTSDB_OK;
 	struct Session *info;
+	gchar *log_name, *what;
 	gint i;
 
 	assert(NULL != user_data);
 	info = user_data;
 
+	/* A log the store failed on is partly stored, neither the rest of the
+	 * logs nor the diff are loaded over it */
 	assert(NULL != files);
-	for(i = 0; i < n_files; i++) {
-		EventsDb_AddLog(info->eventsdb, g_file_get_path(files[i]));
-		/* TODO: handle errors here */
+	for(i = 0; i < n_files && EVENTSDB_STORE_FAILED != err; i++) {
+		log_name = g_file_get_path(files[i]);
+		err = EventsDb_AddLog(info->eventsdb, log_name);
+		if (EVENTSDB_OK != err) {
+			what = g_strdup_printf("Can't load %s", log_name);
+			gui_show_error(what, err);
+			g_free(what);
+		}
+		g_free(log_name);
 	}
+	info->load_failed = EVENTSDB_STORE_FAILED == err;
+	if (!info->load_failed && EventsDb_RunsCount(info->eventsdb) > 1)
+		EventsDb_DiffRuns(info->eventsdb, 0, 1);
 	/* TODO: change forced type conversion */
 	gui_open_new((GtkApplication *)application, info);
 }
@@ -347,6 +814,8 @@ int gui_main(int argc, char *argv[], struct EventsDb *eventsdb)
 	assert(NULL != app);
 
 	info.eventsdb = eventsdb;
+	info.paging = false;
+	info.load_failed = false;
  	g_signal_connect(app, "startup", G_CALLBACK(gui_startup), &info);
  	g_signal_connect(app, "open", G_CALLBACK(gui_open), &info);
 	status = g_application_run(G_APPLICATION(app), argc, argv);
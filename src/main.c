@@ -1,20 +1,183 @@
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "gui.h"
 
+#define OPTION_STATS "--stats"
+#define OPTION_DIFF  "--diff"
+#define OPTION_TRACE "--trace="
+#define OPTION_CORRELATE_FROM "--correlate-from="
+#define OPTION_CORRELATE_TO   "--correlate-to="
+#define OPTION_MARKER_SEPARATOR ':'
+#define OPTION_MEMORY_BUDGET "--memory-budget="
+#define OPTION_STORE_DIR     "--store-dir="
+#define STORE_DIR_DEFAULT    "/tmp"
+#define MEMORY_BUDGET_UNIT   (1024ULL * 1024)
+
+struct Options {
+	bool stats;
+	bool diff;	/* every log is a run, the first two are compared */
+	const char *trace_name;
+	char *correlate_from;	/* MARKER:PATTERN */
+	char *correlate_to;
+	const char *memory_budget;	/* MiB, NULL or 0 keeps events in memory */
+	const char *store_dir;
+};
+
+/* Takes our options out of argv, GApplication rejects unknown ones */
+static int main_parse_options(int argc, char *argv[], struct Options *options)
+{
+	int i, j;
+
+	memset(options, 0, sizeof(*options));
+	for (i = 1, j = 1; i < argc; i++) {
+		if (0 == strcmp(argv[i], OPTION_STATS))
+			options->stats = true;
+		else if (0 == strcmp(argv[i], OPTION_DIFF))
+			options->diff = true;
+		else if (0 == strncmp(argv[i], OPTION_TRACE, strlen(OPTION_TRACE)))
+			options->trace_name = argv[i] + strlen(OPTION_TRACE);
+		else if (0 == strncmp(argv[i], OPTION_CORRELATE_FROM, 
+			 strlen(OPTION_CORRELATE_FROM)))
+			options->correlate_from = argv[i] + 
+				strlen(OPTION_CORRELATE_FROM);
+		else if (0 == strncmp(argv[i], OPTION_CORRELATE_TO, 
+			 strlen(OPTION_CORRELATE_TO)))
+			options->correlate_to = argv[i] + 
+				strlen(OPTION_CORRELATE_TO);
+		else if (0 == strncmp(argv[i], OPTION_MEMORY_BUDGET, 
+			 strlen(OPTION_MEMORY_BUDGET)))
+			options->memory_budget = argv[i] + 
+				strlen(OPTION_MEMORY_BUDGET);
+		else if (0 == strncmp(argv[i], OPTION_STORE_DIR, 
+			 strlen(OPTION_STORE_DIR)))
+			options->store_dir = argv[i] + strlen(OPTION_STORE_DIR);
+		else
+			argv[j++] = argv[i];
+	}
+	argv[j] = NULL;
+	return j;
+}
+
+/* The budget is in MiB, bytes of it must fit size_t of the 32-bit build */
+static int main_parse_budget(const char *text, size_t *budget)
+{
+	unsigned long long budget_mb;
+	char *end;
+
+	errno = 0;
+	budget_mb = strtoull(text, &end, 10);
+	if (end == text || 0 != *end || '-' == *text || ERANGE == errno ||
+	    budget_mb > SIZE_MAX / MEMORY_BUDGET_UNIT) {
+		printf("%s%s is not a budget in MiB up to %llu\n", 
+			OPTION_MEMORY_BUDGET, text, 
+			(unsigned long long)(SIZE_MAX / MEMORY_BUDGET_UNIT));
+		return -1;
+	}
+	*budget = budget_mb * MEMORY_BUDGET_UNIT;
+	return 0;
+}
+
+/* Out-of-core mode spills events to the store directory, TMPDIR by default */
+static int main_setup_store(struct EventsDb *eventsdb, struct Options *options)
+{
+	const char *directory = options->store_dir;
+	size_t budget;
+
+	if (NULL == options->memory_budget)
+		return 0;
+	if (main_parse_budget(options->memory_budget, &budget))
+		return -1;
+	if (0 == budget)
+		return 0;
+	if (NULL == directory)
+		directory = getenv("TMPDIR");
+	if (NULL == directory)
+		directory = STORE_DIR_DEFAULT;
+
+	if (EVENTSDB_OK != EventsDb_SetStore(eventsdb, directory, budget)) {
+		printf("Can't use %s for the event store\n", directory);
+		return -1;
+	}
+	return 0;
+}
+
+static int main_setup_correlation(struct EventsDb *eventsdb, 
+	struct Options *options)
+{
+	char *from_pattern, *to_pattern;
+
+	if (NULL == options->correlate_from && NULL == options->correlate_to)
+		return 0;
+	if (NULL == options->correlate_from || NULL == options->correlate_to) {
+		printf("Both %s and %s are required\n", 
+			OPTION_CORRELATE_FROM, OPTION_CORRELATE_TO);
+		return -1;
+	}
+
+	from_pattern = strchr(options->correlate_from, OPTION_MARKER_SEPARATOR);
+	to_pattern = strchr(options->correlate_to, OPTION_MARKER_SEPARATOR);
+	if (NULL == from_pattern || NULL == to_pattern) {
+		printf("Correlation side must be MARKER%cPATTERN\n", 
+			OPTION_MARKER_SEPARATOR);
+		return -1;
+	}
+	*from_pattern++ = 0;
+	*to_pattern++ = 0;
+
+	if (EVENTSDB_OK != EventsDb_SetCorrelation(eventsdb, 
+	    options->correlate_from, from_pattern,
+	    options->correlate_to, to_pattern)) {
+		printf("Compiling correlation regexep fails\n");
+		return -1;
+	}
+	return 0;
+}
+
 int main(int argc, char *argv[])
 {
 	struct EventsDb eventsdb;
 	enum EventsDb_Error err_eventdb;
+	struct Options options;
+	struct EventsStats *stats;
 	int status;
 
+	argc = main_parse_options(argc, argv, &options);
+
 	err_eventdb = EventsDb_Init(&eventsdb);
 	if (EVENTSDB_OK != err_eventdb) {
 		printf("Compiling default regexep fails\n");
 		return -1;
 	}
+
+	if (main_setup_store(&eventsdb, &options) ||
+	    main_setup_correlation(&eventsdb, &options)) {
+		EventsDb_Done(&eventsdb);
+		return -1;
+	}
+
+	EventsDb_SetRunPerLog(&eventsdb, options.diff);
+	stats = EventsDb_GetStats(&eventsdb);
+	if (options.stats || NULL != options.trace_name)
+		EventsStats_Enable(stats, NULL != options.trace_name);
+
 	status = gui_main(argc, argv, &eventsdb);
+
+	EventsCorrelate_Print(EventsDb_GetCorrelate(&eventsdb), stdout);
+	EventsDb_DiffPrint(&eventsdb, stdout);
+	if (options.stats) {
+		EventsStats_Print(stats, stdout);
+		EventsDict_Print(EventsDb_GetDict(&eventsdb), stdout);
+		if (NULL != EventsDb_GetStore(&eventsdb))
+			EventsStore_Print(EventsDb_GetStore(&eventsdb), stdout);
+	}
+	if (NULL != options.trace_name && 
+	    EventsStats_WriteTrace(stats, options.trace_name))
+		printf("Can't write trace to %s\n", options.trace_name);
 	EventsDb_Done(&eventsdb);
 
 	return status;
 }
-
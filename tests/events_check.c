@@ -0,0 +1,188 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "events_db.h"
+#include "events_dump.h"
+
+/* A name the log doesn't have gets an empty column and isn't interned */
+static void check_unknown_marker(struct EventsDb *eventsdb, char *known)
+{
+	char *markers[] = { "NO SUCH MARKER", known };
+	size_t strings = eventsdb->dict.slots_used;
+
+	printf("table unknown marker\n");
+	EventsDump_Table(eventsdb, markers, 2, stdout);
+	printf("dict %s\n", strings == eventsdb->dict.slots_used ? 
+		"unchanged" : "grew");
+}
+
+/* Prints what the viewer shows for a log, make check compares it with
+ * tests/golden; with a second log both are loaded as runs and diffed */
+static void check_tables(struct EventsDb *eventsdb)
+{
+	struct EventsPaths *paths;
+	struct EventsPaths_Node *root;
+	char **markers;
+	size_t markers_length;
+
+	markers = EventsDump_Markers(eventsdb, &markers_length);
+
+	printf("table all\n");
+	EventsDump_Table(eventsdb, markers, markers_length, stdout);
+
+	printf("table first marker\n");
+	EventsDump_Table(eventsdb, markers, markers_length > 0 ? 1 : 0, stdout);
+
+	printf("table no markers\n");
+	EventsDump_Table(eventsdb, markers, 0, stdout);
+
+	printf("table warning and above\n");
+	EventsDb_SetSeverityMask(eventsdb,
+		EVENTSDB_SEVERITY_MASK_ALL & ~(1u << EVENTSDB_SEVERITY_INFO));
+	EventsDump_Table(eventsdb, markers, markers_length, stdout);
+	EventsDb_SetSeverityMask(eventsdb, EVENTSDB_SEVERITY_MASK_ALL);
+
+	if (markers_length > 0)
+		check_unknown_marker(eventsdb, markers[0]);
+
+	paths = EventsDb_GetPaths(eventsdb);
+	root = EventsPaths_GetRoot(paths);
+	if (NULL != root->children) {
+		printf("table without %s\n", root->children->name);
+		EventsPaths_SetEnabled(paths, root->children, false);
+		EventsDump_Table(eventsdb, markers, markers_length, stdout);
+		EventsPaths_SetEnabled(paths, root->children, true);
+	}
+
+	free(markers);
+}
+
+/* Rows the viewer highlights in the table of all markers */
+static void check_diverging(struct EventsDb *eventsdb)
+{
+	char **markers;
+	size_t markers_length, i, row;
+
+	markers = EventsDump_Markers(eventsdb, &markers_length);
+	if (EVENTSDB_OK == EventsDb_RequestEventsTable(eventsdb, markers, 
+	    markers_length))
+		for (i = 0; i < markers_length; i++) {
+			row = EventsDb_ResponseDivergingRow(eventsdb, i);
+			if (EVENTSDB_NONE != row)
+				printf("diverging |%s| row %zu\n", markers[i], row);
+		}
+	EventsDb_ResponseFreeMemory(eventsdb);
+	free(markers);
+}
+
+/* Non-empty buckets of all markers and of the first one's table, at the
+ * finest level and at a coarse one */
+static void check_density(struct EventsDb *eventsdb)
+{
+	size_t levels[] = { 0, 4 };
+	char **markers;
+	size_t markers_length, i, bucket, buckets;
+	unsigned int total, table;
+
+	markers = EventsDump_Markers(eventsdb, &markers_length);
+	if (0 == markers_length || EVENTSDB_OK != 
+	    EventsDb_RequestEventsTable(eventsdb, markers, 1)) {
+		EventsDb_ResponseFreeMemory(eventsdb);
+		free(markers);
+		return;
+	}
+
+	for (i = 0; i < sizeof(levels) / sizeof(levels[0]); i++) {
+		buckets = EventsDb_DensityBuckets(eventsdb, levels[i]);
+		printf("density level %zu width %llu buckets %zu\n", levels[i],
+			EventsDb_DensityBucketWidth(eventsdb, levels[i]), buckets);
+		for (bucket = 0; bucket < buckets; bucket++) {
+			total = EventsDensity_GetTotal(&eventsdb->density, 
+				levels[i], bucket);
+			table = EventsDb_ResponseDensityAt(eventsdb, levels[i], 
+				bucket);
+			if (total > 0)
+				printf("density bucket %zu all %u |%s| %u\n", 
+					bucket, total, markers[0], table);
+		}
+	}
+
+	EventsDb_ResponseFreeMemory(eventsdb);
+	free(markers);
+}
+
+static void check_correlate_print(struct EventsCorrelate *correlate)
+{
+	size_t i;
+
+	EventsCorrelate_Print(correlate, stdout);
+	printf("latencies");
+	for (i = 0; i < correlate->latencies_length; i++)
+		printf(" %llu", correlate->latencies[i]);
+	printf("\n");
+}
+
+/* TX and RX events paired by their id, the correlation is set once after
+ * the logs are loaded and once on a new database before they are */
+static void check_correlate(struct EventsDb *eventsdb, int logs, char *log[])
+{
+	struct EventsDb before;
+	struct EventsCorrelate *correlate;
+	int i;
+
+	if (EVENTSDB_OK != EventsDb_SetCorrelation(eventsdb, 
+	    "TX", "id=([0-9]+)", "RX", "id=([0-9]+)"))
+		return;
+	correlate = EventsDb_GetCorrelate(eventsdb);
+	if (NULL == correlate->from.marker || NULL == correlate->to.marker)
+		return;
+
+	printf("correlate after load\n");
+	check_correlate_print(correlate);
+
+	if (EVENTSDB_OK != EventsDb_Init(&before))
+		return;
+	EventsDb_SetRunPerLog(&before, logs > 1);
+	EventsDb_SetCorrelation(&before, 
+		"TX", "id=([0-9]+)", "RX", "id=([0-9]+)");
+	for (i = 0; i < logs; i++)
+		EventsDb_AddLog(&before, log[i]);
+	printf("correlate before load\n");
+	check_correlate_print(EventsDb_GetCorrelate(&before));
+	EventsDb_Done(&before);
+}
+
+int main(int argc, char *argv[])
+{
+	struct EventsDb eventsdb;
+	int i;
+
+	if (argc < 2) {
+		printf("usage: %s LOG [LOG]\n", argv[0]);
+		return 1;
+	}
+	if (EVENTSDB_OK != EventsDb_Init(&eventsdb)) {
+		printf("Compiling default regexep fails\n");
+		return 1;
+	}
+	EventsDb_SetRunPerLog(&eventsdb, argc > 2);
+
+	for (i = 1; i < argc; i++)
+		if (EVENTSDB_OK != EventsDb_AddLog(&eventsdb, argv[i])) {
+			printf("Can't load %s\n", argv[i]);
+			EventsDb_Done(&eventsdb);
+			return 1;
+		}
+
+	EventsDump_Summary(&eventsdb, stdout);
+	check_tables(&eventsdb);
+	check_density(&eventsdb);
+	if (EventsDb_RunsCount(&eventsdb) > 1) {
+		EventsDb_DiffRuns(&eventsdb, 0, 1);
+		EventsDb_DiffPrint(&eventsdb, stdout);
+		check_diverging(&eventsdb);
+	}
+	check_correlate(&eventsdb, argc - 1, &argv[1]);
+
+	EventsDb_Done(&eventsdb);
+	return 0;
+}
@@ -0,0 +1,115 @@
+#include <assert.h>
+#include <stdlib.h>
+#include "events_dump.h"
+
+char **EventsDump_Markers(struct EventsDb *eventsdb, size_t *markers_length)
+{
+	struct markers_queue_entry *np;
+	char **markers;
+	size_t i = 0;
+
+	markers = malloc((eventsdb->m_queue_length + 1) * sizeof(*markers));
+	assert(NULL != markers);
+	for (np = eventsdb->m_queue.tqh_first; np != NULL; np = np->entries.tqe_next)
+		markers[i++] = (char *)np->marker;
+	*markers_length = i;
+	return markers;
+}
+
+static void EventsDump_Path(struct EventsPaths_Node *node, size_t depth,
+	FILE *output)
+{
+	fprintf(output, "%*s%s %zu/%zu\n", (int)(2 * depth), "", node->name,
+		node->events, node->subtree_events);
+	for (node = node->children; node != NULL; node = node->next)
+		EventsDump_Path(node, depth + 1, output);
+}
+
+void EventsDump_Summary(struct EventsDb *eventsdb, FILE *output)
+{
+	struct markers_queue_entry *np;
+	size_t s;
+
+	fprintf(output, "events %zu\n", EventsDb_EventsCount(eventsdb));
+	for (s = 0; s < EVENTSDB_SEVERITY_TOTAL; s++)
+		fprintf(output, "severity %s %zu\n", EventsDb_SeverityName(s),
+			EventsDb_SeverityCount(eventsdb, s));
+	for (np = eventsdb->m_queue.tqh_first; np != NULL; np = np->entries.tqe_next)
+		fprintf(output, "marker %zu |%s|\n", np->id, np->marker);
+	EventsDump_Path(EventsPaths_GetRoot(EventsDb_GetPaths(eventsdb)), 0,
+		output);
+}
+
+static void EventsDump_Rows(struct EventsDb *eventsdb, FILE *output)
+{
+	size_t row, column;
+
+	for (row = 0; row < EventsDb_ResponseGetRows(eventsdb); row++) {
+		for (column = 0; column < EventsDb_ResponseGetColumns(eventsdb);
+		     column++)
+			fprintf(output, "|%s",
+				EventsDb_ResponseGetValueAt(eventsdb, column, row));
+		fprintf(output, "|\n");
+	}
+}
+
+enum EventsDb_Error EventsDump_Table(struct EventsDb *eventsdb,
+	char *markers[], size_t markers_length, FILE *output)
+{
+	enum EventsDb_Error err;
+	size_t first = 0;
+
+	do {
+		EventsDb_SetWindow(eventsdb, first);
+		err = EventsDb_RequestEventsTable(eventsdb, markers, markers_length);
+		if (err) {
+			EventsDb_ResponseFreeMemory(eventsdb);
+			return err;
+		}
+		EventsDump_Rows(eventsdb, output);
+		first = EventsDb_WindowLast(eventsdb);
+		EventsDb_ResponseFreeMemory(eventsdb);
+	} while (EventsDb_IsWindowed(eventsdb) &&
+		 first < EventsDb_EventsCount(eventsdb));
+
+	return EVENTSDB_OK;
+}
+
+enum EventsDb_Error EventsDump_TableBackward(struct EventsDb *eventsdb,
+	char *markers[], size_t markers_length, FILE *output)
+{
+	enum EventsDb_Error err = EVENTSDB_OK;
+	char **windows = NULL;
+	size_t windows_length = 0, window_size, last, i;
+	FILE *window;
+
+	last = EventsDb_EventsCount(eventsdb);
+	do {
+		windows = realloc(windows, (windows_length + 1) * sizeof(*windows));
+		assert(NULL != windows);
+		EventsDb_SetWindowBefore(eventsdb, last);
+		err = EventsDb_RequestEventsTable(eventsdb, markers, markers_length);
+		if (err) {
+			EventsDb_ResponseFreeMemory(eventsdb);
+			break;
+		}
+		window = open_memstream(&windows[windows_length], &window_size);
+		assert(NULL != window);
+		EventsDump_Rows(eventsdb, window);
+		fclose(window);
+		windows_length++;
+		/* Pages back have to tile the events */
+		assert(!EventsDb_IsWindowed(eventsdb) ||
+		       (EventsDb_WindowLast(eventsdb) == last &&
+			EventsDb_WindowFirst(eventsdb) < last));
+		last = EventsDb_WindowFirst(eventsdb);
+		EventsDb_ResponseFreeMemory(eventsdb);
+	} while (EventsDb_IsWindowed(eventsdb) && last > 0);
+
+	for (i = windows_length; i > 0; i--) {
+		fputs(windows[i - 1], output);
+		free(windows[i - 1]);
+	}
+	free(windows);
+	return err;
+}
@@ -0,0 +1,21 @@
+#ifndef __EVENTS_DUMP__
+#define __EVENTS_DUMP__
+
+#include <stdio.h>
+#include "events_db.h"
+
+/* Names of all markers in the markers queue order, free the array only */
+char **EventsDump_Markers(struct EventsDb *eventsdb, size_t *markers_length);
+
+void EventsDump_Summary(struct EventsDb *eventsdb, FILE *output);
+
+/* Every window of the table one after another, so that in memory and out
+ * of core tables print the same */
+enum EventsDb_Error EventsDump_Table(struct EventsDb *eventsdb,
+	char *markers[], size_t markers_length, FILE *output);
+
+/* Same rows paged from the end with EventsDb_SetWindowBefore */
+enum EventsDb_Error EventsDump_TableBackward(struct EventsDb *eventsdb,
+	char *markers[], size_t markers_length, FILE *output);
+
+#endif
@@ -0,0 +1,227 @@
+#include <locale.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "events_db.h"
+#include "events_dump.h"
+
+/* Loads the same log with every engine and compares their dumps with the
+ * reference: the regex parser and the in-memory table builder. Every
+ * pattern set runs in the C and in a UTF-8 locale, where regexec reads 
+ * invalid bytes differently. Built with
+ * -fsanitize=fuzzer it is a libFuzzer target, otherwise main() runs the
+ * files given on the command line, which is also how AFL drives it */
+
+enum FuzzEngine {
+	FUZZ_REFERENCE,
+	FUZZ_UVM_FAST_PATH,
+	FUZZ_COMPILED,
+	FUZZ_OUT_OF_CORE,
+	FUZZ_TOTAL
+};
+
+static const char *FuzzEngineNames[FUZZ_TOTAL] = {
+	[FUZZ_REFERENCE]     = "reference",
+	[FUZZ_UVM_FAST_PATH] = "uvm fast path",
+	[FUZZ_COMPILED]      = "compiled patterns",
+	[FUZZ_OUT_OF_CORE]   = "out of core",
+};
+
+static const unsigned int FuzzMasks[] = {
+	EVENTSDB_SEVERITY_MASK_ALL,
+	EVENTSDB_SEVERITY_MASK_ALL & ~(1u << EVENTSDB_SEVERITY_INFO),
+};
+
+struct FuzzPatterns {
+	const char *line_valid;
+	const char *marker;
+	const char *time;
+	const char *message;
+	const char *path;
+};
+
+/* NULL line_valid keeps the defaults, the custom set takes the UVM logs
+ * too but with other spans */
+static const struct FuzzPatterns FuzzPatternSets[] = {
+	{ NULL, NULL, NULL, NULL, NULL },
+	{ "^UVM_\\(INFO\\|ERROR\\|FATAL\\)[^@]*@",
+	  "\\[[A-Za-z_0-9.]+\\]", "@ [0-9]+", "\\][^[]*$",
+	  " (/[a-z_/]+) " },
+};
+
+static const char *FuzzLocales[] = { "C", "C.UTF-8" };
+
+static const char *fuzz_directory(void)
+{
+	const char *directory = getenv("TMPDIR");
+
+	return NULL != directory ? directory : "/tmp";
+}
+
+/* Both table builders take the events of a run of equal times together,
+ * out of core runs longer than a window are split and their rows differ */
+static bool fuzz_runs_fit(struct EventsDb *eventsdb)
+{
+	struct time_queue_entry *np;
+	const char *previous = NULL;
+	size_t run_length = 0;
+
+	for (np = eventsdb->t_queue.tqh_first; np != NULL;
+	     np = np->entries.tqe_next) {
+		run_length = np->time == previous ? run_length + 1 : 1;
+		if (run_length > EVENTSDB_WINDOW_EVENTS)
+			return false;
+		previous = np->time;
+	}
+	return true;
+}
+
+static char *fuzz_dump(const char *log_name, enum FuzzEngine engine,
+	const struct FuzzPatterns *patterns, unsigned int mask, bool *runs_fit)
+{
+	struct EventsDb eventsdb;
+	char **markers, *dump = NULL;
+	size_t markers_length, dump_size;
+	FILE *output;
+
+	if (EVENTSDB_OK != EventsDb_Init(&eventsdb))
+		abort();
+	if (NULL != patterns->line_valid &&
+	    (EVENTSDB_OK != EventsDb_NewPatterns(&eventsdb, 
+	     patterns->line_valid, patterns->marker, patterns->time, 
+	     patterns->message) ||
+	     EVENTSDB_OK != EventsDb_NewPathPattern(&eventsdb, patterns->path)))
+		abort();
+	if (FUZZ_REFERENCE == engine || FUZZ_COMPILED == engine)
+		eventsdb.uvm_fast_path = false;
+	if (FUZZ_REFERENCE == engine)
+		eventsdb.compiled_path = false;
+	if (FUZZ_COMPILED == engine && !eventsdb.compiled_path)
+		abort();
+	if (FUZZ_OUT_OF_CORE == engine &&
+	    EVENTSDB_OK != EventsDb_SetStore(&eventsdb, fuzz_directory(), 0))
+		abort();
+	if (EVENTSDB_OK != EventsDb_AddLog(&eventsdb, log_name))
+		abort();
+	if (NULL != runs_fit)
+		*runs_fit = fuzz_runs_fit(&eventsdb);
+
+	output = open_memstream(&dump, &dump_size);
+	if (NULL == output)
+		abort();
+	EventsDump_Summary(&eventsdb, output);
+	EventsDb_SetSeverityMask(&eventsdb, mask);
+	markers = EventsDump_Markers(&eventsdb, &markers_length);
+	if (EVENTSDB_OK != EventsDump_Table(&eventsdb, markers, markers_length,
+	    output))
+		abort();
+	fprintf(output, "backward\n");
+	if (EVENTSDB_OK != EventsDump_TableBackward(&eventsdb, markers, 
+	    markers_length, output))
+		abort();
+	fclose(output);
+
+	/* The viewer keeps its last table until Done */
+	if (EVENTSDB_OK != EventsDb_RequestEventsTable(&eventsdb, markers,
+	    markers_length))
+		abort();
+	free(markers);
+	EventsDb_Done(&eventsdb);
+	return dump;
+}
+
+static void fuzz_compare(const char *log_name, 
+	const struct FuzzPatterns *patterns, unsigned int mask)
+{
+	char *reference, *dump;
+	enum FuzzEngine engine;
+	bool runs_fit;
+
+	reference = fuzz_dump(log_name, FUZZ_REFERENCE, patterns, mask, 
+		&runs_fit);
+	for (engine = FUZZ_REFERENCE + 1; engine < FUZZ_TOTAL; engine++) {
+		/* Split runs are still paged, only their rows differ */
+		dump = fuzz_dump(log_name, engine, patterns, mask, NULL);
+		if ((FUZZ_OUT_OF_CORE != engine || runs_fit) &&
+		    0 != strcmp(reference, dump)) {
+			fprintf(stderr, "%s differs from %s, mask %x, "
+				"patterns %s, locale %s\n"
+				"--- %s\n%s--- %s\n%s",
+				FuzzEngineNames[engine],
+				FuzzEngineNames[FUZZ_REFERENCE], mask,
+				NULL != patterns->line_valid ? 
+					patterns->line_valid : "default",
+				setlocale(LC_CTYPE, NULL),
+				FuzzEngineNames[FUZZ_REFERENCE], reference,
+				FuzzEngineNames[engine], dump);
+			abort();
+		}
+		free(dump);
+	}
+	free(reference);
+}
+
+#define FUZZ_LENGTH(array) (sizeof(array) / sizeof((array)[0]))
+
+/* Patterns are compiled under the locale they run in */
+static void fuzz_log(const char *log_name)
+{
+	size_t i, j, k;
+
+	for (i = 0; i < FUZZ_LENGTH(FuzzLocales); i++) {
+		if (NULL == setlocale(LC_CTYPE, FuzzLocales[i]))
+			continue;
+		for (j = 0; j < FUZZ_LENGTH(FuzzPatternSets); j++)
+			for (k = 0; k < FUZZ_LENGTH(FuzzMasks); k++)
+				fuzz_compare(log_name, &FuzzPatternSets[j],
+					FuzzMasks[k]);
+	}
+	setlocale(LC_CTYPE, "C");
+}
+
+/* The parser reports malformed lines on stdout */
+int LLVMFuzzerInitialize(__attribute__((unused))int *argc,
+	__attribute__((unused))char ***argv)
+{
+	if (NULL == freopen("/dev/null", "w", stdout))
+		abort();
+	return 0;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	char log_name[1024];
+	FILE *log;
+	int fd;
+
+	snprintf(log_name, sizeof(log_name), "%s/events_fuzz-XXXXXX",
+		fuzz_directory());
+	fd = mkstemp(log_name);
+	if (-1 == fd)
+		abort();
+	log = fdopen(fd, "w");
+	if (NULL == log || size != fwrite(data, 1, size, log))
+		abort();
+	fclose(log);
+
+	fuzz_log(log_name);
+	unlink(log_name);
+	return 0;
+}
+
+#ifndef EVENTS_FUZZ_LIBFUZZER
+int main(int argc, char *argv[])
+{
+	int i;
+
+	LLVMFuzzerInitialize(&argc, &argv);
+	for (i = 1; i < argc; i++) {
+		fuzz_log(argv[i]);
+		fprintf(stderr, "%s: engines agree\n", argv[i]);
+	}
+	return 0;
+}
+#endif